@@ -0,0 +1,235 @@
+/*
+ * arith.h -- EDSAC register arithmetic
+ *            (shared by the simulator and programs translated to C++)
+ */
+#ifndef ARITH_H
+#define ARITH_H
+
+#include "attributes.h"
+#include "codes.h"
+
+// Registers are arrays of words, least significant first: every word but
+// the last holds 17 bits plus the sandwich bit, the last 17 bits.  None
+// of these functions needs Qt, so translated programs can be compiled
+// with nothing but this file, attributes.h, and codes.h.
+
+// negate (2's complement) the content of the specified number of
+// words at dest
+inline void negate(WORD dest[], int num_words)
+{
+    for (int i = 0; i < num_words; i++) {
+        dest[i] = ~dest[i] & MAX_LOWORD;
+    }
+    ++dest[0];
+    for (int i = 0; i < num_words - 1 and dest[i] > MAX_LOWORD; i++) {
+        dest[i] &= MAX_LOWORD;
+        ++dest[i+1];
+    }
+    dest[num_words - 1] &= MAX_HIWORD;
+}
+
+// add the contents of src to dest (both num_words long)
+inline void add_to(const WORD src[], WORD dest[], int num_words)
+{
+    for (int i = 0; i < num_words; i++) {
+        dest[i] += src[i];
+        if (dest[i] > MAX_LOWORD and i < num_words - 1) {
+            dest[i] &= MAX_LOWORD;
+            ++dest[i+1];
+        }
+    }
+    dest[num_words - 1] &= MAX_HIWORD;
+}
+
+// subtract the contents of src from dest (both num_words long)
+inline void subtract_from(const WORD src[], WORD dest[], int num_words)
+{
+    for (int i = 0; i < num_words; i++) {
+        dest[i] -= src[i];
+        if (dest[i] > MAX_LOWORD and i < num_words - 1) {
+            dest[i] &= MAX_LOWORD;
+            --dest[i+1];
+        }
+    }
+    dest[num_words - 1] &= MAX_HIWORD;
+}
+
+// perform a single-bit left shift on a register value with the
+// specified number of words
+inline void shift_left(WORD reg[], int num_words)
+{
+    bool prev_bit = false;
+    for (int i = 0; i < num_words; i++) {
+        reg[i] = (reg[i] << 1) | prev_bit;
+        prev_bit = (reg[i] & (SANDWICH_BIT << 1)) != 0;
+        reg[i] &= MAX_LOWORD;
+    }
+    reg[num_words - 1] &= MAX_HIWORD;
+}
+
+// perform a single-bit arithmetic right shift on a register value with the
+// specified number of words
+inline void shift_right(WORD reg[], int num_words)
+{
+    reg[num_words-1] |= (reg[num_words-1] & SIGN_BIT) << 1;
+    for (int i = 0; i < num_words; i++) {
+        reg[i] >>= 1;
+        if (i != num_words - 1) {
+            reg[i] |= (reg[i+1] & 0x1) << (LOWORD_BITS - 1);
+        }
+    }
+}
+
+// compute the number of bits to shift, given the "control word"
+// (specified by the position of the rightmost 1-bit in the word)
+inline int shift_length(WORD control)
+{
+    int result = 1;
+    while ((control & 0x1) == 0) {
+        ++result;
+        control >>= 1;
+    }
+    return result;
+}
+
+// add the (possibly long) number low:high into the upper half of the
+// 4-word accumulator
+inline void add_number(WORD acc[], WORD low, WORD high)
+{
+    acc[2] += low;
+    if (acc[2] > MAX_LOWORD) {
+        acc[2] &= MAX_LOWORD;
+        ++acc[3];
+    }
+    acc[3] += high;
+    acc[3] &= MAX_HIWORD;
+}
+
+// subtract the (possibly long) number low:high from the upper half of
+// the 4-word accumulator
+inline void subtract_number(WORD acc[], WORD low, WORD high)
+{
+    acc[2] -= low;
+    if (acc[2] > MAX_LOWORD) {
+        --acc[3];
+        acc[2] &= MAX_LOWORD;
+    }
+    acc[3] -= high;
+    acc[3] &= MAX_HIWORD;
+}
+
+// roundoff the 4-word accumulator to 34 bits
+// (i.e., add 2⁻³⁵ to it)
+inline void round_off(WORD acc[])
+{
+    acc[1] += SANDWICH_BIT;
+    if (acc[1] > MAX_LOWORD) {
+        acc[1] &= MAX_LOWORD;
+        if (++acc[2] > MAX_LOWORD) {
+            acc[2] &= MAX_LOWORD;
+            ++acc[3];
+            acc[3] &= MAX_HIWORD;
+        }
+    }
+}
+
+// multiply the 2-word multiplicand by the 2-word multiplier, and add
+// the product to (or subtract it from) the 4-word accumulator
+inline void multiply(WORD acc[], const WORD mcand[], const WORD mplier[],
+                     bool subtract)
+{
+    LONGWORD x_mcand = long_word(mcand[0], mcand[1]);
+    if ((x_mcand & LONG_SIGN_BIT) != 0) {
+        x_mcand = -x_mcand & MAX_LONGWORD;
+        subtract = not subtract;
+    }
+    WORD x_mplier[4] = {};
+    // multiplier to use is value shifted left twice
+    x_mplier[0] = mplier[0]; x_mplier[1] = mplier[1];
+    if ((x_mplier[1] & SIGN_BIT) != 0) {
+        negate(x_mplier, 2);
+        subtract = not subtract;
+    }
+    shift_left(x_mplier, 4); shift_left(x_mplier, 4);
+    for (int i = 0; i < 35; i++) {
+        if ((x_mcand & 0x1) != 0) {
+            if (subtract) { subtract_from(x_mplier, acc, 4); }
+            else { add_to(x_mplier, acc, 4); }
+        }
+        x_mcand >>= 1;
+        shift_left(x_mplier, 4);
+    }
+}
+
+// multiply as multiply() does, with the multiplicand and multiplier as
+// long words (packed as long_word() packs them), by host arithmetic: the
+// 70-bit product is put together from two partial products, each small
+// enough for 64 bits
+inline void multiply_numbers(WORD acc[], LONGWORD mcand, LONGWORD mplier,
+                             bool subtract)
+{
+    const LONGWORD LOW_MASK = (LONGWORD(1) << (2 * LOWORD_BITS)) - 1;
+
+    if ((mcand & LONG_SIGN_BIT) != 0) {
+        mcand = -mcand & MAX_LONGWORD;
+        subtract = not subtract;
+    }
+    if ((mplier & LONG_SIGN_BIT) != 0) {
+        mplier = -mplier & MAX_LONGWORD;
+        subtract = not subtract;
+    }
+    // product (times 4, as the accumulator is aligned) = low + high * 2^36
+    LONGWORD t1 = (mplier << 2) * (mcand & MAX_LOWORD);
+    LONGWORD t2 = (mplier << 2) * (mcand >> LOWORD_BITS);
+    LONGWORD low = t1 + ((t2 & MAX_LOWORD) << LOWORD_BITS);
+    LONGWORD high = (t2 >> LOWORD_BITS) + (low >> (2 * LOWORD_BITS));
+    low &= LOW_MASK;
+
+    LONGWORD acc_low = (LONGWORD(acc[1]) << LOWORD_BITS) | acc[0];
+    LONGWORD acc_high = (LONGWORD(acc[3]) << LOWORD_BITS) | acc[2];
+    if (subtract) {
+        high += (acc_low < low);
+        acc_low -= low;
+        acc_high -= high;
+    } else {
+        acc_low += low;
+        acc_high += high + (acc_low >> (2 * LOWORD_BITS));
+    }
+    acc_low &= LOW_MASK;
+    acc_high &= MAX_LONGWORD;
+    acc[0] = acc_low & MAX_LOWORD;
+    acc[1] = acc_low >> LOWORD_BITS;
+    acc[2] = acc_high & MAX_LOWORD;
+    acc[3] = acc_high >> LOWORD_BITS;
+}
+
+// longest loop body examined for an idle loop
+const unsigned MAX_LOOP = 16;
+
+// the net change (mod 2^35) one trip round a loop makes to the
+// accumulator, in delta, if the orders from top up to the branch at "at"
+// are at most MAX_LOOP A and S orders (false if not); word(a) is the
+// word at store location (a)
+template <typename Word>
+inline bool loop_delta(ADDR top, ADDR at, Word word, LONGWORD& delta)
+{
+    const int A = Codes::code_of('A'), S = Codes::code_of('S');
+
+    if (unsigned(at - top) > MAX_LOOP) { return false; }
+    delta = 0;
+    for (ADDR p = top; p != at; p++) {
+        WORD w = word(p);
+        int f = w >> (ADDR_BITS + FLAG_BITS);
+        ADDR a = (w >> FLAG_BITS) & MAX_ADDR;
+        bool lflag = (w & MAX_FLAG) != 0;
+        if (f != A and f != S) { return false; }
+        a &= ~ADDR(lflag);
+        WORD low = lflag ? word(a) : 0;
+        LONGWORD v = long_word(low, word(a + lflag));
+        delta += (f == A) ? v : -v;
+    }
+    delta &= MAX_LONGWORD;
+    return true;
+}
+
+#endif
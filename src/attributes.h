@@ -7,7 +7,7 @@
 #include <cstdint>                 // for [u]int..._t
 #include <cmath>                   // for log2()
 
-typedef uint32_t TICKS;            // clock ticks (10000/sec)
+typedef uint64_t TICKS;            // clock ticks (10000/sec)
 
 typedef uint16_t ADDR;             // 11 bits/address
 const ADDR ALL_LINES = ~0;         // for displaying all lines in a tube
@@ -43,6 +43,7 @@ const WORD MAX_FLAG = (~(~WORD(0) << FLAG_BITS));   // flag mask
 // architecture attributes
 const unsigned NUM_LONG_TANKS = 32;
 const unsigned LONG_TANK_WORDS = 32;                // # words in long tank
+const unsigned STORE_WORDS = NUM_LONG_TANKS * LONG_TANK_WORDS;
 const unsigned STORE_DISPLAY_LINES = LONG_TANK_WORDS / 2;
 
 const unsigned TANK_BITS = log2(NUM_LONG_TANKS);    // # addr bits specifying
@@ -0,0 +1,402 @@
+/*
+ * batch.cc -- definitions for Batch class
+ *             (several machines run in lockstep on one program)
+ */
+#include <QChar>
+#include <QString>
+
+#include <algorithm>
+#include <vector>
+
+#include "batch.h"
+
+#include "arith.h"
+#include "attributes.h"
+#include "codes.h"
+#include "edsac.h"
+#include "input.h"
+#include "output.h"
+#include "tank.h"
+
+using Codes::code_of;       // punch code for given letter
+
+// the orders done for every machine at once are compiled for AVX2 as
+// well as for the baseline instruction set where GCC can pick between
+// them when the program starts
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__) \
+    && !defined(_WIN32)
+#define LOCKSTEP __attribute__((target_clones("avx2", "default")))
+#else
+#define LOCKSTEP
+#endif
+
+// set dst to src on the machines in mask (the rest keep their values)
+static inline void merge(WORD& dst, WORD src, WORD mask)
+    { dst = (src & mask) | (dst & ~mask); }
+
+Batch::Batch(Edsac *e, unsigned n)
+    : num_lanes(std::min(n, unsigned(LANES)))
+{
+    std::vector<WORD> image = e->store_image();
+    for (unsigned a = 0; a < STORE_WORDS; a++) {
+        std::fill(store[a], store[a] + LANES, image[a]);
+    }
+    for (unsigned w = 0; w < 4; w++) {
+        std::fill(acc[w], acc[w] + LANES, e->acc[w]);
+    }
+    for (unsigned w = 0; w < 2; w++) {
+        std::fill(mcand[w], mcand[w] + LANES, e->mcand[w]);
+        std::fill(mplier[w], mplier[w] + LANES, e->mplier[w]);
+    }
+    for (unsigned i = 0; i < LANES; i++) {
+        sct[i] = e->sct[0];
+        running[i] = (i < num_lanes);
+        stopped_by[i] = running[i] ? Edsac::NOT_STOPPED : Edsac::STOPPED;
+        last_loop[i] = e->last_loop;
+        last_printed[i] = e->last_printed;
+        sim_time[i] = e->sim_time;
+        orders[i] = e->order_count;  // (as loading the tape left it)
+        mount_tape(i, e->input->text(), e->input->position(),
+                   e->input->line());
+        shift[i] = Teleprinter::LETTERS;
+    }
+}
+
+// give the machine in lane its own tape, read from character pos
+void Batch::mount_tape(unsigned lane, const QString& text, int pos,
+                       int line)
+{
+    tapes[lane].set_up_tape(text);
+    tapes[lane].set_position(pos, line);
+}
+
+// queue digits for the machine in lane to dial, one each time it stops
+// at a Z order
+void Batch::queue_dial(unsigned lane, const QString& digits)
+{
+    for (QChar c : digits) {
+        if (c.isDigit()) {
+            dial[lane].push_back(c == '0' ? 10 : c.digitValue());
+        }
+    }
+}
+
+// run every machine until it stops (or has run n orders)
+void Batch::run(uint64_t n)
+{
+    limit = n;
+    for (;;) {
+        // the machines furthest back in the program go first (the rest
+        // wait for them), so machines that branch apart meet again
+        // where the branches join, or at the end of a loop
+        ADDR at = MAX_ADDR + 1;
+        unsigned lead = 0;
+        for (unsigned i = 0; i < num_lanes; i++) {
+            if (running[i] and sct[i] < at) { at = sct[i]; lead = i; }
+        }
+        if (at > MAX_ADDR) { break; }   // (every machine has stopped)
+
+        const WORD *w = store[at % STORE_WORDS];
+        Row mask;
+        unsigned members = 0;
+        for (unsigned i = 0; i < LANES; i++) {
+            bool with = running[i] and sct[i] == at and w[i] == w[lead];
+            mask[i] = with ? ~WORD(0) : 0;
+            members += with;
+        }
+        if (members > 1) {
+            step_together(mask, at, w[lead]);
+            together += members;
+        } else {
+            step(lead);
+            ++alone;
+        }
+    }
+}
+
+// do order w, at sequence control value "at", for the machines in mask
+LOCKSTEP
+void Batch::step_together(const Row& mask, ADDR at, WORD w)
+{
+    char func = w >> (ADDR_BITS + FLAG_BITS);
+    ADDR a = (w >> FLAG_BITS) & MAX_ADDR;
+    bool lflag = (w & MAX_FLAG) != 0;
+    ADDR next = (at + 1) & MAX_ADDR;
+
+    // the (possibly long) number at a
+    ADDR ad = a & ~ADDR(lflag);
+    const WORD *low = store[ad % STORE_WORDS];
+    const WORD *high = store[(ad + lflag) % STORE_WORDS];
+    WORD long_mask = lflag ? ~WORD(0) : 0;
+
+    switch (func) {
+        case code_of('A'): case code_of('S'): case code_of('C'): {
+            // all bits set when subtracting (x ^ s) - s negates x
+            WORD s = (func == code_of('S')) ? ~WORD(0) : 0;
+            bool and_mplier = (func == code_of('C'));
+            for (unsigned i = 0; i < LANES; i++) {
+                WORD lo = low[i] & long_mask, hi = high[i];
+                merge(mcand[0][i], lo, mask[i]);
+                merge(mcand[1][i], hi, mask[i]);
+                if (and_mplier) { lo &= mplier[0][i]; hi &= mplier[1][i]; }
+                WORD x2 = acc[2][i] + ((lo ^ s) - s);
+                WORD carry = (x2 >> LOWORD_BITS) & 0x1;
+                WORD x3 = acc[3][i] + ((hi ^ s) - s) + ((carry ^ s) - s);
+                merge(acc[2][i], x2 & MAX_LOWORD, mask[i]);
+                merge(acc[3][i], x3 & MAX_HIWORD, mask[i]);
+            }
+            break;
+        }
+        case code_of('H'):
+            for (unsigned i = 0; i < LANES; i++) {
+                merge(mplier[0][i], low[i] & long_mask, mask[i]);
+                merge(mplier[1][i], high[i], mask[i]);
+            }
+            break;
+        case code_of('T'): case code_of('U'): {
+            bool clear = (func == code_of('T'));
+            WORD *lo = store[ad % STORE_WORDS];
+            WORD *hi = store[(ad + lflag) % STORE_WORDS];
+            for (unsigned i = 0; i < LANES; i++) {
+                if (lflag) { merge(lo[i], acc[2][i], mask[i]); }
+                merge(hi[i], acc[3][i], mask[i]);
+                if (clear) {
+                    for (unsigned j = 0; j < 4; j++) { acc[j][i] &= ~mask[i]; }
+                }
+            }
+            break;
+        }
+        case code_of('R'):
+            for (int n = shift_length(w); n > 0; n--) {
+                for (unsigned i = 0; i < LANES; i++) {
+                    WORD x3 = acc[3][i] | (acc[3][i] & SIGN_BIT) << 1;
+                    for (unsigned j = 0; j < 3; j++) {
+                        merge(acc[j][i], acc[j][i] >> 1
+                                | (acc[j+1][i] & 0x1) << (LOWORD_BITS - 1),
+                              mask[i]);
+                    }
+                    merge(acc[3][i], x3 >> 1, mask[i]);
+                }
+            }
+            break;
+        case code_of('L'):
+            for (int n = shift_length(w); n > 0; n--) {
+                for (unsigned i = 0; i < LANES; i++) {
+                    merge(acc[3][i], (acc[3][i] << 1
+                            | acc[2][i] >> (LOWORD_BITS - 1)) & MAX_HIWORD,
+                          mask[i]);
+                    for (unsigned j = 2; j > 0; j--) {
+                        merge(acc[j][i], (acc[j][i] << 1
+                                | acc[j-1][i] >> (LOWORD_BITS - 1))
+                                & MAX_LOWORD, mask[i]);
+                    }
+                    merge(acc[0][i], (acc[0][i] << 1) & MAX_LOWORD, mask[i]);
+                }
+            }
+            break;
+        case code_of('E'): case code_of('G'): {
+            WORD negative = (func == code_of('G')) ? SIGN_BIT : 0;
+            bool back = false;
+            for (unsigned i = 0; i < LANES; i++) {
+                bool taken = (acc[3][i] & SIGN_BIT) == negative;
+                merge(order[i], w, mask[i]);
+                if (mask[i] != 0) {
+                    sct[i] = taken ? a : next;
+                    back |= (sct[i] <= at);
+                }
+            }
+            if (back) {
+                for (unsigned i = 0; i < num_lanes; i++) {
+                    if (mask[i] != 0 and sct[i] <= at) {
+                        check_loop(i, at, func);
+                    }
+                }
+            }
+            for (unsigned i = 0; i < num_lanes; i++) {
+                if (mask[i] != 0) { count(i, Edsac::timings[int(func)]); }
+            }
+            return;
+        }
+        case code_of('Y'):
+            for (unsigned i = 0; i < LANES; i++) {
+                WORD x1 = acc[1][i] + SANDWICH_BIT;
+                WORD x2 = acc[2][i] + ((x1 >> LOWORD_BITS) & 0x1);
+                WORD x3 = acc[3][i] + ((x2 >> LOWORD_BITS) & 0x1);
+                merge(acc[1][i], x1 & MAX_LOWORD, mask[i]);
+                merge(acc[2][i], x2 & MAX_LOWORD, mask[i]);
+                merge(acc[3][i], x3 & MAX_HIWORD, mask[i]);
+            }
+            break;
+        case code_of('X'):
+            break;
+        default:
+            // multiplication, input & output, and stops, machine by
+            // machine
+            for (unsigned i = 0; i < num_lanes; i++) {
+                if (mask[i] != 0) { step(i); }
+            }
+            return;
+    }
+    for (unsigned i = 0; i < LANES; i++) {
+        merge(order[i], w, mask[i]);
+        if (mask[i] != 0) { sct[i] = next; }
+    }
+    for (unsigned i = 0; i < num_lanes; i++) {
+        if (mask[i] != 0) { count(i, Edsac::timings[int(func)]); }
+    }
+}
+
+// fetch & execute the order at sequence control for the machine in lane
+void Batch::step(unsigned lane)
+{
+    ADDR at = sct[lane];
+    WORD w = store[at % STORE_WORDS][lane];
+    sct[lane] = (at + 1) & MAX_ADDR;
+    order[lane] = w;
+    char func = w >> (ADDR_BITS + FLAG_BITS);
+    ADDR a = (w >> FLAG_BITS) & MAX_ADDR;
+    bool lflag = (w & MAX_FLAG) != 0;
+
+    // the lane's registers, and the (possibly long) word at a
+    WORD x[4] = { acc[0][lane], acc[1][lane], acc[2][lane], acc[3][lane] };
+    WORD mc[2] = { mcand[0][lane], mcand[1][lane] };
+    WORD mp[2] = { mplier[0][lane], mplier[1][lane] };
+    ADDR ad = a & ~ADDR(lflag);
+    WORD& low = store[ad % STORE_WORDS][lane];
+    WORD& high = store[(ad + lflag) % STORE_WORDS][lane];
+    WORD lo = lflag ? low : 0;
+
+    switch (func) {
+        case code_of('A'):
+            mc[0] = lo; mc[1] = high; add_number(x, mc[0], mc[1]); break;
+        case code_of('S'):
+            mc[0] = lo; mc[1] = high; subtract_number(x, mc[0], mc[1]); break;
+        case code_of('C'):
+            mc[0] = lo; mc[1] = high;
+            add_number(x, mc[0] & mp[0], mc[1] & mp[1]);
+            break;
+        case code_of('H'):
+            mp[0] = lo; mp[1] = high; break;
+        case code_of('V'): case code_of('N'):
+            mc[0] = lo; mc[1] = high;
+            multiply(x, mc, mp, func == code_of('N'));
+            mc[0] = mc[1] = 0;
+            break;
+        case code_of('T'): case code_of('U'):
+            if (lflag) { low = x[2]; }
+            high = x[3];
+            if (func == code_of('T')) { std::fill(x, x + 4, 0); }
+            break;
+        case code_of('R'):
+            for (int n = shift_length(w); n > 0; n--) { shift_right(x, 4); }
+            break;
+        case code_of('L'):
+            for (int n = shift_length(w); n > 0; n--) { shift_left(x, 4); }
+            break;
+        case code_of('E'):
+            if ((x[3] & SIGN_BIT) == 0) { sct[lane] = a; }
+            break;
+        case code_of('G'):
+            if ((x[3] & SIGN_BIT) != 0) { sct[lane] = a; }
+            break;
+        case code_of('I'): {
+            if (lflag) { low = 0; }
+            char ch = tapes[lane].next_char(false);
+            if (ch == Tape_Reader::ENDFILE or ch == Tape_Reader::INVALID) {
+                stop(lane, ch == Tape_Reader::ENDFILE ? Edsac::END_OF_TAPE
+                                                      : Edsac::BAD_CHARACTER);
+                sct[lane] = at;
+            } else {
+                high = ch;
+            }
+            break;
+        }
+        case code_of('O'): {
+            // (the high word of a long location is the odd one)
+            ADDR p = ((a & 0x1) == 0) ? a + lflag : a;
+            char c = (store[p % STORE_WORDS][lane]
+                        >> (HIWORD_BITS - CHAR_BITS)) & MAX_CHAR;
+            print(lane, c);
+            last_printed[lane] = c;
+            break;
+        }
+        case code_of('F'):
+            if (lflag) { low = 0; }
+            high = WORD(last_printed[lane]) << (ADDR_BITS + FLAG_BITS);
+            break;
+        case code_of('X'):
+            break;
+        case code_of('Y'):
+            round_off(x);
+            break;
+        case code_of('Z'):
+            stop(lane, Edsac::HALT_ORDER);
+            break;
+        default:
+            stop(lane, Edsac::INVALID_ORDER);
+            break;
+    }
+    for (unsigned j = 0; j < 4; j++) { acc[j][lane] = x[j]; }
+    for (unsigned j = 0; j < 2; j++) {
+        mcand[j][lane] = mc[j];
+        mplier[j][lane] = mp[j];
+    }
+    if (running[lane] and sct[lane] <= at) { check_loop(lane, at, func); }
+    count(lane, Edsac::timings[int(func)]);
+
+    // a Z order takes the next digit dialed, and the machine carries on
+    if (stopped_by[lane] == Edsac::HALT_ORDER and not dial[lane].empty()) {
+        acc[3][lane] = (acc[3][lane] + 2 * dial[lane].front()) & MAX_HIWORD;
+        dial[lane].pop_front();
+        stopped_by[lane] = Edsac::NOT_STOPPED;
+        running[lane] = true;
+    }
+}
+
+// count n orders taking t ticks for the machine in lane, stopping it if
+// that reaches the limit
+void Batch::count(unsigned lane, TICKS t, uint64_t n)
+{
+    sim_time[lane] += t;
+    orders[lane] += n;
+    if (running[lane] and orders[lane] >= limit) {
+        stop(lane, Edsac::CONDITION);
+    }
+}
+
+// stop the machine in lane
+void Batch::stop(unsigned lane, int why)
+{
+    running[lane] = false;
+    stopped_by[lane] = why;
+}
+
+// check a backward jump (from the order at location "at") for a loop
+// that can never end, as Edsac::check_loop() does: a jump to itself, or
+// (when there is no limit on the orders run, so that a headless run
+// would be skipping idle loops) a short loop of A and S orders that
+// adds nothing to the accumulator
+void Batch::check_loop(unsigned lane, ADDR at, char func)
+{
+    ADDR top = sct[lane];
+    if (func != code_of('E') and func != code_of('G')) { return; }
+    if (top == at) { stop(lane, Edsac::HUNG); return; }
+
+    bool again = (last_loop[lane] == at);
+    last_loop[lane] = at;
+    if (limit != ~uint64_t(0) or not again) { return; }
+    LONGWORD delta;
+    auto word = [this, lane](ADDR a) { return store[a % STORE_WORDS][lane]; };
+    if (loop_delta(top, at, word, delta) and delta == 0) {
+        stop(lane, Edsac::HUNG);
+    }
+}
+
+// print character c on the machine in lane's teleprinter (as a headless
+// run echoes it)
+void Batch::print(unsigned lane, char c)
+{
+    QChar qc = Teleprinter::translate(c, shift[lane]);
+    if (qc == 'n') { printed[lane] += '\n'; }
+    else if (not qc.isLower()) { printed[lane] += qc; }
+}
@@ -0,0 +1,95 @@
+/*
+ * batch.h -- declarations for Batch class
+ *            (several machines run in lockstep on one program)
+ */
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <QString>
+
+#include <deque>
+
+#include "attributes.h"
+#include "input.h"
+#include "output.h"
+
+class Edsac;
+
+// Runs up to LANES copies of the machine, each with its own dial digits
+// or tape, from the state the simulator is in when the batch is made.
+// Every register word and store location is kept as a row of LANES
+// words (one per machine), so that while the machines' sequence control
+// registers and current orders agree, one order is done for all of them
+// at once by loops over the rows that the compiler turns into vector
+// instructions (with AVX2, one for all eight machines).  A machine whose
+// sequence control differs from the rest -- after a branch that went a
+// different way, say -- drops out and is interpreted a word at a time
+// until it rejoins them.  Multiplication, input and output, and stops
+// are done machine by machine even in lockstep.  Each machine runs as
+// "qedsac --headless" would run it alone: idle loops that can never end
+// are stopped as hung, and a Z order takes the next dial digit queued.
+class Batch
+{
+public:
+    static const unsigned LANES = 8;    // most machines run together
+
+    // n (at most LANES) copies of the machine as it is now
+    Batch(Edsac *e, unsigned n);
+
+    // give lane its own tape (read from character pos, on the given
+    // line), or digits to dial each time it stops at a Z order
+    void mount_tape(unsigned lane, const QString& text, int pos = 0,
+                    int line = 1);
+    void queue_dial(unsigned lane, const QString& digits);
+
+    // run every machine until it stops, or has run its limit of orders
+    void run(uint64_t limit = ~uint64_t(0));
+
+    // how a machine's run went (stop reasons are Edsac::Stop_Reason's)
+    const QString& output(unsigned lane) const { return printed[lane]; }
+    int stop_reason(unsigned lane) const { return stopped_by[lane]; }
+    ADDR stopped_at(unsigned lane) const { return sct[lane]; }
+    uint64_t orders_executed(unsigned lane) const { return orders[lane]; }
+    TICKS time(unsigned lane) const { return sim_time[lane]; }
+
+    // orders run by machines in lockstep (with at least one other
+    // machine), and one machine at a time
+    uint64_t lockstep_orders() const { return together; }
+    uint64_t single_orders() const { return alone; }
+private:
+    // a register word or store location, across the machines; masks
+    // have all bits set for the machines an order is done for
+    typedef WORD Row[LANES];
+
+    void step_together(const Row& mask, ADDR at, WORD w);
+    void step(unsigned lane);
+    void count(unsigned lane, TICKS t, uint64_t n = 1);
+    void stop(unsigned lane, int why);
+    void check_loop(unsigned lane, ADDR at, char func);
+    void print(unsigned lane, char c);
+
+    unsigned num_lanes;
+    uint64_t limit = ~uint64_t(0);
+
+    // registers & store
+    Row acc[4], mcand[2], mplier[2];
+    Row store[STORE_WORDS];
+    ADDR sct[LANES];
+    WORD order[LANES];
+
+    // each machine's run
+    bool running[LANES];
+    int stopped_by[LANES];
+    ADDR last_loop[LANES];
+    char last_printed[LANES];
+    TICKS sim_time[LANES];
+    uint64_t orders[LANES];
+    Tape_Reader tapes[LANES];
+    std::deque<unsigned> dial[LANES];
+    QString printed[LANES];
+    Teleprinter::Shift_Mode shift[LANES];
+
+    uint64_t together = 0, alone = 0;
+};
+
+#endif
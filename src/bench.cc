@@ -0,0 +1,112 @@
+/*
+ * bench.cc -- definitions for Bench class
+ *             (one tape timed under each engine configuration)
+ */
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cstdio>
+
+#include "bench.h"
+
+#include "edsac.h"
+#include "headless.h"
+#include "output.h"
+#include "settings.h"
+
+static const unsigned REPEATS = 3;      // runs of each (the best is kept)
+
+// the configurations, slowest first
+static const struct Engine {
+    const char *name;
+    bool native_loader, fusion, intrinsics, jit;
+} ENGINES[] = {
+    { "interpreted", false, false, false, false },
+    { "native load", true,  false, false, false },
+    { "fusion",      true,  true,  false, false },
+    { "intrinsics",  true,  false, true,  false },
+    { "jit",         true,  false, false, true  },
+    { "all",         true,  true,  true,  true  },
+};
+
+Bench::Bench(Edsac *e, const QString& tape)
+    : edsac(e), tape(tape)
+{}
+
+// run every configuration (at most limit orders each, after loading) and
+// print the table; returns the exit status
+int Bench::run(uint64_t limit)
+{
+    Teleprinter::Shift_Mode shift = Teleprinter::LETTERS;
+    edsac->set_print_hook([this, &shift](char c) {
+        QChar qc = Teleprinter::translate(c, shift);
+        if (qc == 'n') { output += '\n'; }
+        else if (not qc.isLower()) { output += qc; }
+    });
+    Settings::set_load_cache(false);
+
+    printf("%-12s %10s %12s %14s %10s  %s\n", "engine", "load (ms)",
+        "orders", "orders/sec", "sim/real", "output");
+    int status = 0;
+    for (const Engine& e : ENGINES) {
+        Settings::set_native_loader(e.native_loader);
+        Settings::set_fusion(e.fusion);
+        Settings::set_intrinsics(e.intrinsics);
+        Settings::set_jit(e.jit);
+
+        Timing best = {};
+        bool same = true;
+        for (unsigned r = 0; r < REPEATS; r++) {
+            output.clear();
+            shift = Teleprinter::LETTERS;
+            Timing t = time_once(limit);
+            if (checked and output != expected) { same = false; }
+            if (r == 0) { best = t; continue; }
+            best.load_ns = std::min(best.load_ns, t.load_ns);
+            best.run_ns = std::min(best.run_ns, t.run_ns);
+        }
+
+        double load = best.load_ns / 1e9, run = best.run_ns / 1e9;
+        printf("%-12s %10.3f %12llu %14.0f %10.0f  %s\n", e.name,
+            load * 1e3, (unsigned long long)best.orders,
+            run > 0 ? best.orders / run : 0.0,
+            best.simulated / 10000.0 / std::max(load + run, 1e-9),
+            not checked ? "-" : same ? "ok" : "differs");
+        fflush(stdout);
+        if (not same) { status = 1; }
+        if (best.stopped_by != Edsac::HALT_ORDER
+            and best.stopped_by != Edsac::CONDITION
+            and best.stopped_by != Edsac::HUNG)
+        {
+            fprintf(stderr, "qedsac: %s: %s\n", e.name,
+                Headless::describe(best.stopped_by));
+            status = 1;
+        }
+    }
+    edsac->set_print_hook(nullptr);
+    return status;
+}
+
+// load and run the tape once, timing each part
+Bench::Timing Bench::time_once(uint64_t limit)
+{
+    Timing t;
+    QElapsedTimer clock;
+    TICKS start = edsac->time();
+
+    clock.start();
+    edsac->load_program(tape);
+    edsac->run_to_program();
+    t.load_ns = clock.nsecsElapsed();
+
+    uint64_t loaded = edsac->orders_executed();
+    clock.start();
+    if (limit == ~uint64_t(0)) { edsac->run_to_stop(); }
+    else { edsac->run_orders(limit); }
+    t.run_ns = clock.nsecsElapsed();
+
+    t.orders = edsac->orders_executed() - loaded;
+    t.simulated = edsac->time() - start;
+    t.stopped_by = edsac->stop_reason();
+    return t;
+}
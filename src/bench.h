@@ -0,0 +1,52 @@
+/*
+ * bench.h -- declarations for Bench class
+ *            (one tape timed under each engine configuration)
+ */
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <QString>
+
+#include <cstdint>
+
+#include "attributes.h"
+
+class Edsac;
+
+// Runs a tape under each configuration of the engine in turn -- plain
+// interpretation (the initial orders read the tape order by order), the
+// native loader, each fast path on its own, and everything together --
+// and prints a line for each: how long the tape took to load (until the
+// program proper starts), how many orders were run after that and how
+// many a second, the ratio of simulated to real time, and whether the
+// teleprinter output was what was expected.  Each configuration is run
+// a few times and its best times kept; the load cache is never used.
+class Bench
+{
+public:
+    Bench(Edsac *e, const QString& tape);
+
+    // the teleprinter output every run should produce
+    void expect(const QString& output) { expected = output; checked = true; }
+
+    // run every configuration (at most limit orders each, after loading)
+    // and print the table; returns the exit status
+    int run(uint64_t limit);
+private:
+    struct Timing {
+        int64_t load_ns, run_ns;    // real time to load, then to run
+        uint64_t orders;            // # run after loading
+        TICKS simulated;            // loading and running
+        int stopped_by;
+    };
+
+    Timing time_once(uint64_t limit);
+
+    Edsac *edsac;
+    QString tape;
+    QString expected;
+    bool checked = false;
+    QString output;                 // (of the run under way)
+};
+
+#endif
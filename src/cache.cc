@@ -0,0 +1,172 @@
+/*
+ * cache.cc -- definitions for Load_Cache class
+ *             (saved images of loaded programs)
+ */
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+#include <algorithm>
+
+#include "cache.h"
+
+#include "attributes.h"
+#include "edsac.h"
+#include "input.h"
+#include "settings.h"
+#include "tank.h"
+
+// identifies (this version of) an image file
+static const quint32 MAGIC = 0x45445332;       // "EDS2"
+
+Load_Cache::Load_Cache(Edsac *e)
+    : edsac(e), touched(STORE_WORDS), written(STORE_WORDS)
+{
+    WORD **r = regs;
+    for (Tank *t : { &e->acc, &e->mcand, &e->mplier, &e->sct, &e->order }) {
+        for (auto p = t->begin(); p != t->end(); p++) { *r++ = p; }
+    }
+}
+
+// set up the mounted tape's image on a freshly prepared machine
+// (false if there is none, or if it depends on store contents that have
+// since changed)
+bool Load_Cache::restore()
+{
+    QByteArray k = key();
+    QFile f(file_name(k));
+    if (not f.open(QIODevice::ReadOnly)) { return false; }
+    QDataStream in(&f);
+
+    quint32 magic, num_reads, num_writes;
+    QByteArray saved_key;
+    in >> magic >> saved_key >> num_reads;
+    if (in.status() != QDataStream::Ok or magic != MAGIC or saved_key != k
+        or num_reads > STORE_WORDS)
+    {
+        return false;
+    }
+    for (quint32 i = 0; i < num_reads; i++) {
+        quint32 a, value;
+        in >> a >> value;
+        if (in.status() != QDataStream::Ok or a >= STORE_WORDS
+            or word(a) != value)
+        {
+            return false;
+        }
+    }
+
+    // read everything before changing anything (the file may be damaged)
+    std::vector<quint32> writes;
+    in >> num_writes;
+    if (num_writes > STORE_WORDS) { return false; }
+    for (quint32 i = 0; i < 2 * num_writes; i++) {
+        quint32 w;
+        in >> w;
+        writes.push_back(w);
+    }
+    quint32 reg_words[NUM_REG_WORDS];
+    for (int i = 0; i < NUM_REG_WORDS; i++) { in >> reg_words[i]; }
+    qint32 tape_pos, tape_line;
+    quint64 ticks, orders;
+    QByteArray chars;
+    in >> tape_pos >> tape_line >> ticks >> orders >> chars;
+    if (in.status() != QDataStream::Ok
+        or tape_pos < 0 or tape_pos > edsac->input->text().size()
+        or edsac->order_count + orders > edsac->order_limit)
+    {
+        return false;
+    }
+
+    for (quint32 i = 0; i < num_writes; i++) {
+        if (writes[2*i] >= STORE_WORDS) { return false; }
+    }
+    for (quint32 i = 0; i < num_writes; i++) {
+        word(writes[2*i]) = writes[2*i+1];
+    }
+    for (int i = 0; i < NUM_REG_WORDS; i++) { *regs[i] = reg_words[i]; }
+    edsac->input->set_position(tape_pos, tape_line);
+    edsac->sim_time += ticks;
+    edsac->order_count += orders;
+    for (char c : chars) {
+        edsac->print_char(c);
+        edsac->last_printed = c;
+    }
+    return true;
+}
+
+// watch the initial orders load the mounted tape
+void Load_Cache::watch()
+{
+    std::fill(touched.begin(), touched.end(), false);
+    std::fill(written.begin(), written.end(), false);
+    reads.clear();
+    printed.clear();
+    start_time = edsac->sim_time;
+    start_orders = edsac->order_count;
+    watching = true;
+}
+
+// the program has just started: save the image of the machine
+void Load_Cache::save()
+{
+    watching = false;
+    QByteArray k = key();
+    QString name = file_name(k);
+    QDir().mkpath(QFileInfo(name).absolutePath());
+    QFile f(name);
+    if (not f.open(QIODevice::WriteOnly)) { return; }   // just don't cache
+    QDataStream out(&f);
+
+    out << MAGIC << k << quint32(reads.size() / 2);
+    for (WORD w : reads) { out << quint32(w); }
+    quint32 num_writes = std::count(written.begin(), written.end(), true);
+    out << num_writes;
+    for (unsigned a = 0; a < STORE_WORDS; a++) {
+        if (written[a]) { out << quint32(a) << quint32(word(a)); }
+    }
+    for (int i = 0; i < NUM_REG_WORDS; i++) { out << quint32(*regs[i]); }
+    out << qint32(edsac->input->position()) << qint32(edsac->input->line())
+        << quint64(edsac->sim_time - start_time)
+        << quint64(edsac->order_count - start_orders) << printed;
+    f.close();
+    prune(QFileInfo(name).absolutePath());
+}
+
+// delete all but the most recently saved images in dir
+void Load_Cache::prune(const QString& dir)
+{
+    QFileInfoList images =
+        QDir(dir).entryInfoList(QStringList("*.img"), QDir::Files, QDir::Time);
+    for (int i = MAX_IMAGES; i < int(images.size()); i++) {
+        QFile::remove(images[i].absoluteFilePath());
+    }
+}
+
+// hash of everything that decides what loading the mounted tape does
+QByteArray Load_Cache::key() const
+{
+    QCryptographicHash h(QCryptographicHash::Sha1);
+    h.addData(edsac->input->text().toUtf8());
+    h.addData(QByteArray(1, '\0'));
+    h.addData(QByteArray::number(Settings::initial_orders()));
+    h.addData(Settings::ignore_case() ? "i" : "c", 1);
+    return h.result();
+}
+
+// where the image for key k is kept
+QString Load_Cache::file_name(const QByteArray& k) const
+{
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+             + "/images");
+    return dir.filePath(QString(k.toHex()) + ".img");
+}
+
+// the store word at location (a)
+WORD& Load_Cache::word(ADDR a)
+{
+    return edsac->store[tank_num(a)][a & OFFSET_MASK];
+}
@@ -0,0 +1,77 @@
+/*
+ * cache.h -- declarations for Load_Cache class
+ *            (saved images of loaded programs)
+ */
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <vector>
+
+#include "attributes.h"
+
+class Edsac;
+
+// Keeps, on disk, the state of the machine just as each tape's program
+// starts (the first order run outside the initial orders), so a later
+// start of the same tape can skip the loading.  The image holds every
+// store word the load wrote, the registers, tape position, time taken,
+// and anything printed on the way (which is printed again), and is keyed
+// by the tape text and the settings that affect loading.  Store words the
+// load read before writing them (words left by an earlier program) are
+// saved too, and the image is only used if they still hold the same
+// values.  Only the most recently saved images are kept.
+class Load_Cache
+{
+public:
+    Load_Cache(Edsac *e);
+
+    // set up the mounted tape's image on a freshly prepared machine
+    // (false if there is none to use)
+    bool restore();
+
+    // watch the initial orders load the mounted tape, then save the
+    // image when the program starts (or forget it, if interrupted)
+    void watch();
+    void save();
+    void cancel() { watching = false; }
+    bool is_watching() const { return watching; }
+
+    // record store accesses (while watching)
+    void note_read(ADDR a, WORD value)
+    {   if (watching and not touched[a % STORE_WORDS]) {
+            touched[a % STORE_WORDS] = true;
+            reads.push_back(a % STORE_WORDS);
+            reads.push_back(value);
+        }
+    }
+    void note_write(ADDR a)
+    {   if (watching) {
+            touched[a % STORE_WORDS] = written[a % STORE_WORDS] = true;
+        }
+    }
+    void note_print(char c) { if (watching) { printed += c; } }
+private:
+    static const int NUM_REG_WORDS = 10;
+    static const int MAX_IMAGES = 64;   // kept on disk (the newest)
+
+    void prune(const QString& dir);
+    QByteArray key() const;
+    QString file_name(const QByteArray& k) const;
+    WORD& word(ADDR a);
+
+    Edsac *edsac;
+    WORD *regs[NUM_REG_WORDS];      // every short tank word
+
+    // state of the load being watched
+    bool watching = false;
+    std::vector<bool> touched, written;
+    std::vector<WORD> reads;        // (address, value) pairs
+    QByteArray printed;             // by orders planted during loading
+    TICKS start_time;
+    uint64_t start_orders;
+};
+
+#endif
@@ -50,7 +50,7 @@ void Clock::paintEvent(QPaintEvent *e)
     const int mh_radius
         = Layout::SIZE.value(Settings::scale_factor()).minute_hand;
     qp.setPen(QPen(Qt::white, 2));
-    int mins = curr_time / TICKS_PER_SECOND / 60 % 60;
+    int mins = int(curr_time / TICKS_PER_SECOND / 60 % 60);
     double t = ((mins*6 - 90) % 360) * M_PI / 180.0;
     int dx = round(mh_radius*cos(t)),
         dy = round(mh_radius*sin(t));
@@ -60,13 +60,13 @@ void Clock::paintEvent(QPaintEvent *e)
     const int sh_radius
         = Layout::SIZE.value(Settings::scale_factor()).second_hand;
     qp.setPen(QPen(Qt::red, 1));
-    int secs = curr_time / TICKS_PER_SECOND % 60;
+    int secs = int(curr_time / TICKS_PER_SECOND % 60);
     t = ((secs*6 - 90) % 360) * M_PI / 180.0;
     dx = round(sh_radius*cos(t)); dy = round(sh_radius*sin(t));
     qp.drawLine(x, y, x+dx, y+dy);
 
-    // [original has hours mod 60 instead of 100]
-    int hours = curr_time / TICKS_PER_SECOND / 60 / 60 % 100;
+    // [original has hours mod 60; we don't wrap at all]
+    TICKS hours = curr_time / TICKS_PER_SECOND / 60 / 60;
 
     // digital clock (if selected or hours >= 1)
     if (hours >= 1 or Settings::digital_clock()) {
@@ -78,19 +78,21 @@ void Clock::paintEvent(QPaintEvent *e)
         QString time = "%1:%2:%3";
         qp.drawText(Layout::DIMEN.value(Settings::scale_factor()).digital_clock,
                     Qt::AlignHCenter | Qt::AlignTop,
-                    time.arg(hours,2,10,QChar('0'))
+                    time.arg(qulonglong(hours),2,10,QChar('0'))
                         .arg(mins,2,10,QChar('0'))
                         .arg(secs,2,10,QChar('0')));
     }
 }
 
-// advance clock (10000 ticks/sec)
+// catch up with the machine's time (10000 ticks/sec)
 // should we update only if a second has passed?
 // --> yes, for now
-void Clock::advance(TICKS increment)
+void Clock::sync(TICKS machine_time)
 {
-    bool needs_repaint = (curr_time + increment) / TICKS_PER_SECOND
-                            > curr_time / TICKS_PER_SECOND;
-    curr_time += increment;
+    now = machine_time;
+    // (stepping back past the last reset shows zero, not a wrapped time)
+    TICKS t = (now > base) ? now - base : 0;
+    bool needs_repaint = t / TICKS_PER_SECOND != curr_time / TICKS_PER_SECOND;
+    curr_time = t;
     if (needs_repaint) { repaint(); }
 }
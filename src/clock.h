@@ -16,12 +16,15 @@ public:
 
     Clock(QWidget *parent = nullptr) : QWidget(parent) {}
 
-    void reset() { curr_time = 0; update(); }
-    void advance(TICKS increment);
+    // clock shows time since last reset (machine time is kept by Edsac)
+    void reset() { base = now; curr_time = 0; update(); }
+    void sync(TICKS machine_time);
 protected:
     void paintEvent(QPaintEvent *e);
 private:
-    TICKS curr_time = 0;
+    TICKS now = 0;          // latest machine time
+    TICKS base = 0;         // machine time at last reset
+    TICKS curr_time = 0;    // time shown
 };
 
 #endif
@@ -0,0 +1,84 @@
+/*
+ * codes.h -- the EDSAC 5-bit character code
+ *            (shared by the simulator, tape reader, teleprinter, and
+ *             programs translated to C++)
+ */
+#ifndef CODES_H
+#define CODES_H
+
+#include <cstdint>
+
+// Every table of the code is here, each indexed by the code (0-31), with
+// tables for looking codes up by character built from them at compile
+// time -- so finding a code is an index into an array, wherever it is
+// done.  Characters are Unicode code points; only the Latin-1 ones are
+// in the lookup tables (a search finds the few Greek letters).  Nothing
+// here needs Qt.
+namespace Codes {
+
+const int NUM_CODES = 32;
+const unsigned LATIN_1 = 256;       // characters in the lookup tables
+
+// functions as written in this program's sources, with ASCII stand-ins
+// for the Greek letters (as the teleprinter prints them literally)
+constexpr char PUNCH[] = "PQWERTYUIOJ#SZK*.F@D!HNM&LXGABCV";
+
+// perforator letter and figure codes (as punched, and as shown on the
+// display tubes and in post-mortems)
+constexpr char16_t LETTERS[] = u"PQWERTYUIOJπS"  u"ZK*.FθDΦHNMΔLXGABCV";
+constexpr char16_t FIGURES[] = u"0123456789J#\"" u"§(*.F@D!+-'&%XG:?()";
+
+// note that FIGURES includes alternate chars for Greek letters, as
+// well as perforator codes in WWG1951 but not in Tutorial Guide Table 2
+// (WWG has single quote for both S and M in figure shift, so we
+// substitute a double quote for S here)
+
+// teleprinter output in letter and figure shift (lowercase for control
+// chars)
+constexpr char16_t PRINTED[2][NUM_CODES + 1] = {
+    u"PQWERTYUIOJf" u"S"  u"ZKlxFrD HNMnLXGABCV",     // letter shift
+    u"0123456789bf" u"\"" u"+(lx$r; £,.n)/#-?:=",     // figure shift
+};
+
+// code of character c in table (-1 if it isn't there), by search
+template <typename Char>
+constexpr int find(const Char *table, unsigned c, int i = 0)
+{
+    return (i == NUM_CODES) ? -1
+         : (unsigned(table[i]) == c) ? i : find(table, c, i + 1);
+}
+
+// codes by character (-1 for none)
+struct Lookup { int8_t code[LATIN_1]; };
+
+// (the character values 0 to N-1, for building a Lookup)
+template <unsigned... C> struct Characters {};
+template <unsigned N, unsigned... C>
+struct All_Characters : All_Characters<N - 1, N - 1, C...> {};
+template <unsigned... C>
+struct All_Characters<0, C...> { typedef Characters<C...> type; };
+
+template <typename Char, unsigned... C>
+constexpr Lookup lookup(const Char *table, Characters<C...>)
+    { return Lookup{{ int8_t(find(table, C))... }}; }
+
+constexpr Lookup PUNCH_CODES =
+    lookup(PUNCH, All_Characters<LATIN_1>::type());
+constexpr Lookup LETTER_CODES =
+    lookup(LETTERS, All_Characters<LATIN_1>::type());
+constexpr Lookup FIGURE_CODES =
+    lookup(FIGURES, All_Characters<LATIN_1>::type());
+
+// code for function letter c (as in PUNCH), usable in constant
+// expressions such as case labels
+constexpr int code_of(char c) { return PUNCH_CODES.code[uint8_t(c)]; }
+
+// perforator letter or figure code for character c (-1 if none)
+inline int letter_code(unsigned c)
+    { return (c < LATIN_1) ? LETTER_CODES.code[c] : find(LETTERS, c); }
+inline int figure_code(unsigned c)
+    { return (c < LATIN_1) ? FIGURE_CODES.code[c] : find(FIGURES, c); }
+
+}   // namespace Codes
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ * decimal.cc -- definitions for Decimal namespace
+ *               (EDSAC words as text, for hints and store dumps)
+ */
+#include <cstring>
+
+#include "decimal.h"
+
+#include "codes.h"
+
+// the fraction in x (bits wide, two's complement, so -1 <= x < 1) to the
+// given number of digits, rounded to nearest (halves to even)
+char *Decimal::fraction(char *out, LONGWORD x, unsigned bits,
+                        unsigned digits, unsigned style)
+{
+    const LONGWORD ONE = LONGWORD(1) << (bits - 1);     // (the sign bit)
+    x &= (ONE << 1) - 1;
+    bool negative = (x & ONE) != 0;
+    LONGWORD magnitude = negative ? (ONE << 1) - x : x;
+
+    if (negative) { *out++ = '-'; }
+    else if ((style & PLUS) != 0) { *out++ = '+'; }
+    char *units = out;
+    *out++ = '0' + int(magnitude >> (bits - 1));        // (1 only for -1)
+    if (digits > 0) { *out++ = '.'; }
+
+    // each digit is the next whole part of the remainder times ten
+    LONGWORD r = magnitude & (ONE - 1);
+    for (unsigned i = 0; i < digits; i++) {
+        r *= 10;
+        *out++ = '0' + int(r >> (bits - 1));
+        r &= ONE - 1;
+    }
+
+    // what is left decides the rounding (carrying at most into the units,
+    // which are then 1, as the magnitude is less than 1)
+    bool odd = ((out[-1] - '0') & 1) != 0;
+    if ((style & TRUNCATE) == 0 and (r > ONE / 2 or (r == ONE / 2 and odd))) {
+        char *d = out - 1;
+        for (;;) {
+            if (*d == '.') { --d; }
+            else if (*d == '9') { *d-- = '0'; }
+            else { ++*d; break; }
+        }
+    }
+
+    if ((style & BARE_POINT) != 0 and *units == '0' and digits > 0) {
+        memmove(units, units + 1, out - units - 1);
+        --out;
+    }
+    *out = '\0';
+    return out;
+}
+
+// the integer x, padded to at least width characters
+char *Decimal::integer(char *out, SIGNED_LONGWORD x, unsigned width,
+                       unsigned style)
+{
+    char digits[20], *d = digits + sizeof digits;
+    uint64_t magnitude = (x < 0) ? 0 - uint64_t(x) : uint64_t(x);
+    do {
+        *--d = '0' + int(magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    char sign = (x < 0) ? '-' : ((style & PLUS) != 0) ? '+' : '\0';
+    unsigned n = (digits + sizeof digits - d) + (sign != '\0');
+    if ((style & SPACES) != 0) {
+        for (; n < width; n++) { *out++ = ' '; }
+    }
+    if (sign != '\0') { *out++ = sign; }
+    for (; n < width; n++) { *out++ = '0'; }
+    while (d < digits + sizeof digits) { *out++ = *d++; }
+    *out = '\0';
+    return out;
+}
+
+// the order in word w as "F a S": function letter, address, and S or L
+// (for initial orders 1) or F or D; the address right-justified in width
+// places, and left blank if it is zero, when width is nonzero
+char *Decimal::order(char *out, WORD w, int initial_orders, unsigned width)
+{
+    char16_t func = Codes::LETTERS[(w & MAX_HIWORD) >> (ADDR_BITS+FLAG_BITS)];
+    if (func < 0x80) {
+        *out++ = char(func);
+    } else {                    // (the Greek letters, in two bytes)
+        *out++ = char(0xC0 | func >> 6);
+        *out++ = char(0x80 | (func & 0x3F));
+    }
+    *out++ = ' ';
+
+    unsigned addr = (w >> FLAG_BITS) & MAX_ADDR;
+    if (width == 0) {
+        out = integer(out, addr);
+    } else if (addr == 0) {
+        for (unsigned i = 0; i < width; i++) { *out++ = ' '; }
+    } else {
+        out = integer(out, addr, width, SPACES);
+    }
+
+    bool is_short = (w & MAX_FLAG) == 0;
+    *out++ = ' ';
+    if (initial_orders == 1) {
+        *out++ = is_short ? 'S' : 'L';
+    } else {
+        *out++ = is_short ? 'F' : 'D';
+    }
+    *out = '\0';
+    return out;
+}
+
+// the nul-terminated string s
+char *Decimal::text(char *out, const char *s)
+{
+    while (*s != '\0') { *out++ = *s++; }
+    *out = '\0';
+    return out;
+}
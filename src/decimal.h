@@ -0,0 +1,57 @@
+/*
+ * decimal.h -- declarations for Decimal namespace
+ *              (EDSAC words as text, for hints and store dumps)
+ */
+#ifndef DECIMAL_H
+#define DECIMAL_H
+
+#include <cstddef>
+
+#include "attributes.h"
+
+// Writes fractions, integers, and orders into a buffer the caller
+// provides, working only with integers: a fraction's digits are found by
+// exact long division, so it is correctly rounded (or truncated, as the
+// post-mortem routines do) to any number of places, without going through
+// floating point.  Each function writes a terminating nul and returns a
+// pointer to it, so a line can be built by one call after another and
+// made into a string once.  Text is UTF-8 (function letters include a few
+// Greek ones).  Nothing here needs Qt.
+namespace Decimal {
+
+// how a number is written (or'ed together)
+enum Style {
+    PLUS       = 0x01,  // "+" before numbers that aren't negative
+    BARE_POINT = 0x02,  // ".5" rather than "0.5"
+    TRUNCATE   = 0x04,  // drop digits past the last, rather than round
+    SPACES     = 0x08,  // pad integers with leading spaces, not zeros
+};
+
+// room needed (with the nul) for a fraction to the given number of
+// digits, an integer of at most the given width, and an order (with
+// the address at most 10 places wide)
+constexpr size_t fraction_size(unsigned digits) { return digits + 4; }
+constexpr size_t integer_size(unsigned width)
+    { return (width > 20 ? width : 20) + 2; }
+const size_t ORDER_SIZE = 16;
+
+// the fraction in x (bits wide, two's complement, so -1 <= x < 1) to
+// the given number of digits, rounded to nearest (halves to even)
+char *fraction(char *out, LONGWORD x, unsigned bits, unsigned digits,
+               unsigned style = 0);
+
+// the integer x, padded to at least width characters
+char *integer(char *out, SIGNED_LONGWORD x, unsigned width = 0,
+              unsigned style = 0);
+
+// the order in word w as "F a S": function letter, address, and S or
+// L (for initial orders 1) or F or D; the address right-justified in
+// width places, and left blank if it is zero, when width is nonzero
+char *order(char *out, WORD w, int initial_orders, unsigned width = 0);
+
+// the nul-terminated string s
+char *text(char *out, const char *s);
+
+}   // namespace Decimal
+
+#endif
@@ -242,7 +242,8 @@ void Edit_Window::save_file(bool save_as)
 }
 
 // insert contents of specified file at current cursor position
-void Edit_Window::insert_file(const QString& filename)
+// (returns the text inserted)
+QString Edit_Window::insert_file(const QString& filename)
 {
     if (not filename.isEmpty()) {   // read file and insert contents
         QFile f(filename);
@@ -251,10 +252,12 @@ void Edit_Window::insert_file(const QString& filename)
             QString new_text = in.readAll();
             Edit_Window::current_window()->contents()->
                             textCursor().insertText(new_text);
+            return new_text;
         } else {
             Error::error("Unable to open " + filename);
         }
     }
+    return QString();
 }
 
 // close all currently open editor windows, fail (return false) if one
@@ -75,7 +75,7 @@ public:
 
     static void open_file(const QString& filename);
     void save_file(bool exists);
-    void insert_file(const QString& filename);
+    QString insert_file(const QString& filename);
     static bool close_all();
 
     static void reset_font(const QFont& f);
@@ -5,19 +5,31 @@
 #include <QCoreApplication>
 #include <QThread>
 #include <QTimer>
-#include <QElapsedTimer>
+
+#include <algorithm>
 
 #include "edsac.h"
 
+#include "arith.h"
 #include "attributes.h"
+#include "cache.h"
 #include "clock.h"
+#include "codes.h"
 #include "display.h"
 #include "error.h"
+#include "fusion.h"
 #include "input.h"
+#include "intrinsics.h"
+#include "jit.h"
+#include "journal.h"
+#include "loader.h"
+#include "menu.h"
 #include "output.h"
 #include "settings.h"
 #include "sound.h"
 #include "tank.h"
+#include "translator.h"
+#include "verifier.h"
 
 Edsac *edsac = new Edsac();
 
@@ -38,18 +50,41 @@ Edsac::Edsac()
 
     // tape reader
     input = new Tape_Reader();
+
+    // undo journal (for stepping backwards)
+    journal = new Journal(this);
+
+    // images of loaded programs
+    cache = new Load_Cache(this);
+
+    // library routines run as host code
+    intrinsics = new Intrinsics(this);
+
+    // runs of orders translated to native code
+    jit = new Jit(this);
+
+    // common pairs of orders done as one step
+    fusion = new Fusion(this);
+
+    // checking the fast paths against plain interpretation
+    verifier = new Verifier(this);
 }
 
 // clear the store and registers
 void Edsac::clear()
 {
     if (running or loading) { Error::beep(); return; }
-    display->set_stop_light(false);
+    set_stop_light(false);
     clear_regs();
     for (int i = 0; i < NUM_LONG_TANKS; i++) {
         store[i].clear();
     }
-    display->update();
+    journal->clear();
+    cache->cancel();
+    jit->flush();
+    fusion->flush();
+    intrinsics->flush();
+    refresh();
 }
 
 // start execution of the current program
@@ -59,20 +94,65 @@ void Edsac::start()
     if (running or loading) { Error::beep(); return; }
     if (not input->set_up_tape()) { return; }
 
-    display->set_stop_light(false);
-    load_initial_orders();
-    clear_regs();
-    display->update();
+    prepare();
     running = true;
     halted = false;
     execute();
 }
 
+// load the initial orders and mount the given text as the tape
+// (for runs without an edit window)
+void Edsac::load_program(const QString& tape, uint64_t max_orders)
+{
+    if (running or loading) { Error::beep(); return; }
+    quiet = Settings::headless();
+    input->set_up_tape(tape);
+    order_limit = (max_orders > NO_END - order_count)
+                  ? NO_END : order_count + max_orders;
+    prepare();
+    order_limit = NO_END;
+    reset_enabled = true;
+}
+
+// get ready to run a freshly mounted tape
+void Edsac::prepare()
+{
+    set_stop_light(false);
+    stopped_by = NOT_STOPPED;
+    transcript.clear();
+    transcript_shift = Teleprinter::LETTERS;
+    load_initial_orders();
+    clear_regs();
+
+    // unless the loading is being watched, start from the tape's saved
+    // image, or else read the tape at once (saving the image later)
+    cache->cancel();
+    bool at_once = not (Settings::real_time() and not quiet);
+    bool cached = at_once and Settings::load_cache();
+    if (not cached or not cache->restore()) {
+        if (cached) { cache->watch(); }
+        if (at_once and Settings::initial_orders() == 2
+            and Settings::native_loader())
+        {
+            Loader(this).run();
+        }
+        if (cache->is_watching() and sct[0] >= initial_orders_end) {
+            cache->save();
+        }
+    }
+    journal->clear();
+    jit->flush();
+    fusion->flush();
+    intrinsics->flush();
+    refresh();
+}
+
 // continue execution, starting at the current order
 void Edsac::reset()
 {
     if (running or not reset_enabled) { Error::beep(); return; }
-    display->set_stop_light(false);
+    set_stop_light(false);
+    stopped_by = NOT_STOPPED;
     running = true;
     halted = false;
     execute();
@@ -81,7 +161,8 @@ void Edsac::reset()
 // stop execution of a running program
 void Edsac::stop()
 {   
-    if (running) { halt(0,0); }
+    ++dial_turn;        // (a dial running down stays stopped)
+    if (running) { halt<false>(0); stopped_by = STOPPED; }
     else if (loading) { Error::beep(); }
 }
 
@@ -90,54 +171,305 @@ void Edsac::single()
 {
     if (running or loading) { Error::beep(); return; }
     else if (waiting) { return; }      // race condition w/ multiple clicks?
-    display->set_stop_light(false);
+    set_stop_light(false);
+    restart_pacer();
+    interpret_only = true;      // (one order, not a fast path's many)
     exec_order();
+    interpret_only = false;
+}
+
+// run N orders
+unsigned long Edsac::run_orders(unsigned long n)
+{
+    if (n == 0) { return 0; }
+    uint64_t end = order_count + n;
+    return run_until([this, end]() { return order_count >= end; }, end);
+}
+
+// check library routines run as host code against interpreting them
+unsigned long Edsac::check_intrinsics(unsigned n)
+{
+    return intrinsics->check(n);
+}
+
+// run the mounted tape checking each step of the fast paths against
+// interpreting it (at most n orders)
+unsigned long Edsac::verify_tape(uint64_t n)
+{
+    if (running or loading) { Error::beep(); return 0; }
+    return verifier->run(n);
+}
+
+// check the fast paths against interpreting n random programs
+unsigned long Edsac::verify_random(unsigned n)
+{
+    if (running or loading) { Error::beep(); return 0; }
+    return verifier->check_random(n);
+}
+
+// run the mounted tape to the start of the program proper, and write
+// the program to file_name as C++
+bool Edsac::translate(const QString& file_name, const QString& tape_name)
+{
+    if (running or loading) { Error::beep(); return false; }
+    return Translator(this).write(file_name, tape_name);
+}
+
+// run until sequence control reaches address a
+unsigned long Edsac::run_to_address(ADDR a)
+{
+    return run_until([this, a]() { return sct[0] == (a & MAX_ADDR); },
+                     NO_END, a & MAX_ADDR);
+}
+
+// run until the program proper starts (sequence control leaves the
+// initial orders; at once if the tape was loaded natively)
+unsigned long Edsac::run_to_program()
+{
+    if (sct[0] >= initial_orders_end) { return 0; }
+    return run_until([this]() { return sct[0] >= initial_orders_end; });
+}
+
+using Codes::code_of;       // punch code for given letter
+
+// run until the next order to be executed is an O (print) order
+unsigned long Edsac::run_to_print()
+{
+    return run_until([this]() {
+        return (get_word(sct[0]) >> (ADDR_BITS + FLAG_BITS)) == code_of('O');
+    });
+}
+
+// run until the text printed so far ends with the given text
+unsigned long Edsac::run_to_output(const QString& text)
+{
+    unsigned long start = chars_printed;
+    skip_loops = true;      // idle loops never print
+    unsigned long count = run_until([this, &text, start]() {
+        return chars_printed != start and transcript.endsWith(text);
+    });
+    skip_loops = false;
+    return count;
+}
+
+// copy of the whole store (for post-mortem dumps)
+std::vector<WORD> Edsac::store_image() const
+{
+    std::vector<WORD> image;
+    for (const Tank& t : store) {
+        image.insert(image.end(), t.begin(), t.end());
+    }
+    return image;
+}
+
+// undo the last order executed
+void Edsac::step_back()
+{
+    cache->cancel();
+    if (running or loading or not journal->step_back()) {
+        Error::beep();
+        return;
+    }
+    jit->flush();
+    fusion->flush();
+    intrinsics->flush();
+    reset_enabled = halted = true;
+    set_stop_light(false);
+    refresh();
+}
+
+// run backwards until sequence control reaches address a
+// (or the journal runs out)
+void Edsac::run_back_to(ADDR a)
+{
+    if (running or loading) { Error::beep(); return; }
+    cache->cancel();
+    bool ok;
+    unsigned long count = 0;
+    quiet = true;
+    while ((ok = journal->step_back()) and sct[0] != (a & MAX_ADDR)) {
+        if (++count % 4096 == 0) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+        }
+    }
+    quiet = Settings::headless();
+    jit->flush();
+    fusion->flush();
+    intrinsics->flush();
+    reset_enabled = halted = true;
+    set_stop_light(false);
+    refresh();
+    if (not ok) { Error::beep(); }
+}
+
+// run until the machine stops
+unsigned long Edsac::run_to_stop()
+{
+    skip_loops = true;
+    unsigned long count = run_until([]() { return false; });
+    skip_loops = false;
+    return count;
+}
+
+// run quietly until done() or the machine stops for some other reason
+// (the display is brought up to date once at the end); the fast paths
+// stop short of order count end and of location stop, so that done()
+// can see them
+unsigned long Edsac::run_until(std::function<bool()> done, uint64_t end,
+                               ADDR stop)
+{
+    if (running or loading or not reset_enabled) {
+        Error::beep();
+        return 0;
+    }
+    set_stop_light(false);
+    stopped_by = NOT_STOPPED;
+    running = true;
+    halted = false;
+    order_limit = end;
+    stop_at = stop;
+    unsigned long count = run_quietly(done);
+    order_limit = NO_END;
+    stop_at = NO_STOP;
+    return count;
+}
+
+// run with all per-order display work suppressed until done() or the
+// machine stops, showing a progress readout in the status bar
+// (the display is brought up to date once at the end)
+unsigned long Edsac::run_quietly(std::function<bool()> done)
+{
+    static const unsigned BATCH = 4096;         // orders between UI checks
+    static const qint64 PROGRESS_INTERVAL = 250;    // ms
+
+    unsigned long count = 0;            // (steps: fast paths run many orders)
+    uint64_t start = order_count;
+    QElapsedTimer t;
+    qint64 last_progress = 0;
+    t.start();
+    quiet = true;
+    while (running) {
+        exec_order();
+        ++count;
+        if (not running and dial_queued()) { continue; }
+        if (running and done()) {
+            running = false;
+            reset_enabled = true;
+            stopped_by = CONDITION;
+        } else if (count % BATCH == 0) {    // keep the Stop button alive
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+            if (t.elapsed() - last_progress >= PROGRESS_INTERVAL) {
+                last_progress = t.elapsed();
+                show_progress(order_count - start, last_progress);
+            }
+        }
+    }
+    quiet = Settings::headless();
+    if (last_progress != 0 and stopped_by != HUNG) { menu->clear_hint(); }
+    refresh();
+    return order_count - start;
+}
+
+// show orders/second, simulated time, and the last line of output
+void Edsac::show_progress(uint64_t orders, qint64 msecs)
+{
+    if (Settings::headless()) { return; }
+    TICKS secs = sim_time / 10000;
+    QString time = QString("%1:%2:%3").arg(secs / 3600)
+                    .arg(secs / 60 % 60, 2, 10, QChar('0'))
+                    .arg(secs % 60, 2, 10, QChar('0'));
+    int nl = transcript.lastIndexOf('\n');
+    menu->show_hint(QString("%1 orders/sec   time %2   %3")
+        .arg(orders * 1000 / msecs).arg(time).arg(transcript.mid(nl + 1)));
 }
 
 // kill the currently running program (if any)
 void Edsac::kill()
 {
+    ++dial_turn;
     if (running) { running = waiting = false; }
 }
 
-// process dialed digit n
+// process dialed digit n: the digit goes into the accumulator at once,
+// and the machine carries on (from a timer) once the dial has run down
 void Edsac::dial_digit(unsigned n)
-{   
+{
+    static const int DIAL_RETURN = 1000;    // ms for the dial to return
+    static const int DIAL_PULSE = 100;      // ... and for each pulse
+
     if (running or not reset_enabled) { Error::beep(); return; }
 
     running = true;     // prevent race condition while dialing
-    acc[3] += 2 *n;
+    enter_digit(n);
+    play_sound(":/Dial" + QString::number(n % 10) + ".wav");
+
+    // (stop() or kill() while the dial runs down leave the machine stopped,
+    // and a later dial or run is not disturbed when this timer goes off)
+    int delay = DIAL_RETURN + DIAL_PULSE * n;
+    if (Settings::real_time()) { delay /= Settings::speed(); }
+    else if (not Settings::sound()) { delay = 0; }
+    unsigned turn = ++dial_turn;
+    QTimer::singleShot(delay, [this, turn]() {
+        if (turn != dial_turn or not running) { return; }
+        running = false;    // allow reset() to proceed
+        reset();
+    });
+}
+
+// add dialed digit n to the accumulator
+void Edsac::enter_digit(unsigned n)
+{
+    acc[3] += 2 * n;
     acc[3] &= MAX_HIWORD;
-    display->update_tube(ACC);
-    
-    if (Settings::sound()) {
-        play_sound(":/Dial" + QString::number(n % 10) + ".wav");
-        // wait for sound to finish
-        QElapsedTimer t;    // QThread::msleep doesn't do the job here.
-        int delay = 1000 + 100 * n;
-        t.start();
-        while (not t.hasExpired(delay)) {
-            QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+    update_tube(ACC);
+    if (Settings::journal_depth() != 0) { journal->anchor(); }
+}
+
+// queue digits to be dialed, one each time the machine next stops at a
+// Z order while running quietly (for runs with nobody at the dial)
+void Edsac::queue_dial(const QString& digits)
+{
+    for (QChar c : digits) {
+        if (c.isDigit()) {
+            dial_queue.push_back(c == '0' ? 10 : c.digitValue());
         }
     }
+}
 
-    running = false;    // allow reset() to proceed
-    reset();
+// after a Z order, dial the next queued digit (if any) with no delay,
+// and carry on running (true if so)
+bool Edsac::dial_queued()
+{
+    if (stopped_by != HALT_ORDER or dial_queue.empty()) { return false; }
+    enter_digit(dial_queue.front());
+    dial_queue.pop_front();
+    set_stop_light(false);
+    stopped_by = NOT_STOPPED;
+    running = true;
+    halted = false;
+    return true;
 }
 
 // execute the current program
 void Edsac::execute()
 {
-    display->set_stop_light(false);
+    set_stop_light(false);
     running = true;     // redundant, but helps readability
     halted = false;     // redundant, but helps readability
-    while (running) { exec_order(); 
-        QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+    restart_pacer();
+    skip_loops = true;
+    if (Settings::turbo()) {
+        run_quietly([]() { return false; });
+    } else {
+        while (running) { exec_order(); 
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+        }
     }
+    skip_loops = false;
 }
 
 // approximate timings for orders (10 TICKs == 1 millisecond)
-static const TICKS timings[] = {
+const TICKS Edsac::timings[] = {
     15,         // P -- [invalid]
     15,         // Q -- [invalid]
     15,         // W -- [invalid]
@@ -175,366 +507,394 @@ static const TICKS timings[] = {
 // fetch & execute a single order
 void Edsac::exec_order()
 {
+    if (Settings::intrinsics() and not replaying and not interpret_only
+        and intrinsics->run(sct[0]))
+    {
+        return;     // a whole library routine call
+    }
+    if (Settings::jit() and not replaying and not interpret_only
+        and jit->run())
+    {
+        return;     // a run of orders as native code
+    }
+    if (Settings::fusion() and not replaying and not interpret_only
+        and fusion->run(sct[0]))
+    {
+        return;     // a pair of orders as one step
+    }
+    bool journaling = Settings::journal_depth() != 0;
+    if (journaling) { journal->begin_order(); }
+
     // fetch order
-    WORD curr_order = get_word(sct[0]);
-    sct[0] = (sct[0] + 1) & MAX_ADDR; display->update_tube(SCT);
-    order[0] = curr_order; display->update_tube(ORDER);
-    bool lflag = (curr_order & MAX_FLAG) != 0;
+    ADDR at = sct[0];
+    WORD curr_order = get_word(at);
+    sct[0] = (sct[0] + 1) & MAX_ADDR; update_tube(SCT);
+    order[0] = curr_order; update_tube(ORDER);
+    unsigned handler = (curr_order >> ADDR_BITS & MAX_FUNC << FLAG_BITS)
+                       | (curr_order & MAX_FLAG);    // function & flag
     curr_order >>= FLAG_BITS;
     unsigned addr = (curr_order & MAX_ADDR);
     curr_order >>= ADDR_BITS;
     char func = (curr_order & MAX_FUNC);
 
-    // set up timing info if running in "real time" mode
-    if (Settings::real_time()) {
-        waiting = true;
-        TICKS how_long = timings[func] + excess;
-        excess = how_long % 10;
-        QTimer::singleShot(how_long/10, this, [this]() { waiting = false; });
-    }
-
     // execute order
     halted = false;       // redundant?
-    (this->*optab[func])(addr, lflag);
-    display->clock->advance(timings[func]);
+    (this->*optab[handler])(addr);
+    ++order_count;
+    if (running and sct[0] <= at) { check_loop(at, func); }
+    advance_clock(timings[func]);
+    if (journaling) { journal->end_order(); }
+    if (cache->is_watching() and sct[0] >= initial_orders_end) {
+        cache->save();      // the program proper starts here
+    }
+    pace(timings[func]);
+}
 
-    // pause appropriately, if running in "real time" mode
-    if (Settings::real_time()) {
-        while (waiting) {
-            QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
-        }
+// check a backward jump (from the order at location "at", counted
+// already) for an idle loop: a jump to itself is a hang (nothing can ever
+// change); a short loop of A and S orders closing with this branch
+// changes only the accumulator, by the same amount each time round, so
+// all but the last iteration can be done in closed form (as many as keep
+// within run_until's bound)
+void Edsac::check_loop(ADDR at, char func)
+{
+    static const char E = code_of('E'), G = code_of('G');
+
+    ADDR top = sct[0];
+    if (func != E and func != G) { return; }
+    if (top == at) { hang(at); return; }
+
+    // only fast-forward after one complete trip round the loop
+    bool again = (last_loop == at);
+    last_loop = at;
+    if (not skip_loops or interpret_only or not again) { return; }
+
+    // net change to the accumulator (mod 2^35) and time per iteration
+    LONGWORD delta;
+    auto word = [this](ADDR a) { return get_word(a); };
+    if (not loop_delta(top, at, word, delta)) { return; }
+    if (delta == 0) { hang(at); return; }
+    TICKS ticks = timings[func];
+    for (ADDR p = top; p != at; p++) {
+        ticks += timings[get_word(p) >> (ADDR_BITS + FLAG_BITS)];
+    }
+
+    // count the further iterations that will still branch back
+    const SIGNED_LONGWORD HALF = SIGNED_LONGWORD(1) << (LONGWORD_BITS - 1);
+    SIGNED_LONGWORD x = sign_extend(acc[2], acc[3]);
+    SIGNED_LONGWORD d = sign_extend_dword(delta);
+    SIGNED_LONGWORD n;
+    if (func == E) {    // continues while x >= 0
+        n = (d > 0) ? (HALF - 1 - x) / d : x / -d;
+    } else {            // continues while x < 0
+        n = (d > 0) ? (-x - 1) / d : (x + HALF) / -d;
+    }
+    // (whole trips only, and none if the run stops anywhere in the loop)
+    ADDR len = at - top + 1;
+    if (stop_at != NO_STOP and ((stop_at - top) & MAX_ADDR) < len) { return; }
+    uint64_t room = (order_limit > order_count) ? order_limit - order_count
+                                                : 0;
+    if (uint64_t(n) > room / len) { n = room / len; }
+    if (n <= 0) { return; }
+
+    LONGWORD x_new = (long_word(acc[2], acc[3]) + n * delta) & MAX_LONGWORD;
+    acc[2] = x_new & MAX_LOWORD;
+    acc[3] = x_new >> LOWORD_BITS;
+    update_tube(ACC);
+    journal->close_segment();   // (replays don't fast-forward)
+    order_count += n * len;
+    advance_clock(n * ticks);
+    pace(n * ticks);
+}
+
+// stop a program stuck in a loop that can never end
+void Edsac::hang(ADDR at)
+{
+    running = false;
+    halted = reset_enabled = true;
+    stopped_by = HUNG;
+    set_stop_light(true);
+    if (not Settings::headless()) {
+        menu->show_hint("Program hung in a loop at " + QString::number(at));
+    }
+}
+
+// start keeping time from now
+void Edsac::restart_pacer()
+{
+    pace_ticks = 0;
+    pace_speed = Settings::speed();
+    pace_timer.start();
+}
+
+// let t more ticks of simulated time pass; if that puts the simulation
+// ahead of real time (at the selected speed), sleep until real time
+// catches up
+// (quiet runs always go at full speed)
+void Edsac::pace(TICKS t)
+{
+    static const int64_t NSECS_PER_TICK = 100000;   // 10000 ticks/sec
+    static const int64_t MIN_SLEEP = 1000000;       // 1ms
+    static const int64_t MAX_SLEEP = 10000000;      // (keeps UI responsive)
+    static const int64_t MAX_LAG = 100000000;       // don't try to catch up
+
+    if (quiet or Settings::speed() == 0) { return; }
+    if (Settings::speed() != pace_speed) { restart_pacer(); }
+
+    pace_ticks += t;
+    int64_t due = pace_ticks * NSECS_PER_TICK / pace_speed;
+    int64_t ahead = due - pace_timer.nsecsElapsed();
+    if (ahead < -MAX_LAG) {         // fell behind (e.g., window dragged)
+        restart_pacer();
+        return;
+    }
+    waiting = true;
+    while (waiting and ahead >= MIN_SLEEP) {   // (kill() ends the wait)
+        QThread::usleep(std::min(ahead, MAX_SLEEP) / 1000);
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+        ahead = due - pace_timer.nsecsElapsed();
     }
+    waiting = false;
 }
 
-// return punch code for given letter
-inline char code(QChar c)
-    { return QString("PQWERTYUIOJ#SZK*.F@D!HNM&LXGABCV").indexOf(c); }
+// order word for function f, address a (long if flag set)
+static constexpr WORD order_word(char f, unsigned a = 0, bool flag = false)
+{
+    return (WORD(code_of(f)) << (ADDR_BITS + FLAG_BITS))
+           + (a << FLAG_BITS) + flag;
+}
+
+// store images of the initial orders (as set on the uniselectors)
+static constexpr WORD INITIAL_ORDERS_1[] = {    // original initial orders
+    order_word('T'),     order_word('H', 2),    order_word('T'),
+    order_word('E', 6),  order_word('P', 1),    order_word('P', 5),
+    order_word('T'),     order_word('I'),       order_word('A'),
+    order_word('R', 16), order_word('T', 0, 1), order_word('I', 2),
+    order_word('A', 2),  order_word('S', 5),    order_word('E', 21),
+    order_word('T', 3),  order_word('V', 1),    order_word('L', 8),
+    order_word('A', 2),  order_word('T', 1),    order_word('E', 11),
+    order_word('R', 4),  order_word('A', 1),    order_word('L', 0, 1),
+    order_word('A'),     order_word('T', 31),   order_word('A', 25),
+    order_word('A', 4),  order_word('U', 25),   order_word('S', 31),
+    order_word('G', 6)
+};
+static constexpr WORD INITIAL_ORDERS_2[] = {    // final form
+    order_word('T'),       order_word('E', 20),    order_word('P', 1),
+    order_word('U', 2),    order_word('A', 39),    order_word('R', 4),
+    order_word('V'),       order_word('L', 8),     order_word('T'),
+    order_word('I', 1),    order_word('A', 1),     order_word('S', 39),
+    order_word('G', 4),    order_word('L', 0, 1),  order_word('S', 39),
+    order_word('E', 17),   order_word('S', 7),     order_word('A', 35),
+    order_word('T', 20),   order_word('A'),        order_word('H', 8),
+    order_word('A', 40),   order_word('T', 43),    order_word('A', 22),
+    order_word('A', 2),    order_word('T', 22),    order_word('E', 34),
+    order_word('A', 43),   order_word('E', 8),     order_word('A', 42),
+    order_word('A', 40),   order_word('E', 25),    order_word('A', 22),
+    order_word('T', 42),   order_word('I', 40, 1), order_word('A', 40, 1),
+    order_word('R', 16),   order_word('T', 40, 1), order_word('E', 8),
+    order_word('P', 5, 1), order_word('P', 0, 1)
+};
 
 // load the initial orders into the store from the uniselectors
+// (at 10 words/sec in real time; otherwise all at once)
 void Edsac::load_initial_orders()
 {
-    struct Order { 
-        signed char func;
-        unsigned addr;
-        bool flag;
+    static const WORD *images[] = { INITIAL_ORDERS_1, INITIAL_ORDERS_2 };
+    static const unsigned sizes[] = {
+        sizeof(INITIAL_ORDERS_1) / sizeof(WORD),
+        sizeof(INITIAL_ORDERS_2) / sizeof(WORD)
     };
+    const WORD *image = images[Settings::initial_orders() - 1];
+    unsigned size = sizes[Settings::initial_orders() - 1];
+    initial_orders_end = size;
 
-    static const int NUM_SWITCHES = 41;
-    static const Order uniselectors[2][NUM_SWITCHES+1] = {
-        {   // original initial orders
-            {code('T')},     {code('H'), 2},    {code('T')},
-            {code('E'), 6},  {code('P'), 1},    {code('P'), 5},
-            {code('T')},     {code('I')},       {code('A')},
-            {code('R'), 16}, {code('T'), 0, 1}, {code('I'), 2},
-            {code('A'), 2},  {code('S'), 5},    {code('E'), 21},
-            {code('T'), 3},  {code('V'), 1},    {code('L'), 8},
-            {code('A'), 2},  {code('T'), 1},    {code('E'), 11},
-            {code('R'), 4},  {code('A'), 1},    {code('L'), 0, 1},
-            {code('A')},     {code('T'), 31},   {code('A'), 25},
-            {code('A'), 4},  {code('U'), 25},   {code('S'), 31},
-            {code('G'), 6},  {-1}
-        },
-        {   // final form of initial orders
-            {code('T')},       {code('E'), 20},    {code('P'), 1},
-            {code('U'), 2},    {code('A'), 39},    {code('R'), 4},
-            {code('V')},       {code('L'), 8},     {code('T')},
-            {code('I'), 1},    {code('A'), 1},     {code('S'), 39},
-            {code('G'), 4},    {code('L'), 0, 1},  {code('S'), 39},
-            {code('E'), 17},   {code('S'), 7},     {code('A'), 35},
-            {code('T'), 20},   {code('A')},        {code('H'), 8},
-            {code('A'), 40},   {code('T'), 43},    {code('A'), 22},
-            {code('A'), 2},    {code('T'), 22},    {code('E'), 34},
-            {code('A'), 43},   {code('E'), 8},     {code('A'), 42},
-            {code('A'), 40},   {code('E'), 25},    {code('A'), 22},
-            {code('T'), 42},   {code('I'), 40, 1}, {code('A'), 40, 1},
-            {code('R'), 16},   {code('T'), 40, 1}, {code('E'), 8},
-            {code('P'), 5, 1}, {code('P'), 0, 1},  {-1}
-        }
-    };
     loading = true;
-    int orders = Settings::initial_orders() - 1;
-    for (int i = 0; uniselectors[orders][i].func != -1; i++) {
-        store_word(i, (uniselectors[orders][i].func << (ADDR_BITS + FLAG_BITS))
-                      + (uniselectors[orders][i].addr << FLAG_BITS)
-                      + (uniselectors[orders][i].flag));
-        display->repaint();     // d->update() doesn't work here
-
-        // 10 loads/sec in real time (less 1ms for overhead)
-        if (Settings::real_time()) { QThread::msleep(99); }
-        display->clock->advance(1000);
+    restart_pacer();
+    if (Settings::real_time() and not quiet) {
+        for (unsigned i = 0; i < size; i++) {
+            store_word(i, image[i]);
+            display->repaint();     // d->update() doesn't work here
+            advance_clock(1000);
+            pace(1000);
+        }
+    } else {
+        for (unsigned i = 0; i < size; i += LONG_TANK_WORDS) {
+            unsigned n = std::min(size - i, LONG_TANK_WORDS);
+            std::copy(image + i, image + i + n, store[tank_num(i)].begin());
+        }
+        advance_clock(1000 * size);
+        if (not quiet) { display->repaint(); }
     }
     loading = false;
 }
 
 // get the word at store location (a)
-inline WORD Edsac::get_word(ADDR a)
+WORD Edsac::get_word(ADDR a)
 {
     int t = tank_num(a);
-    return word_at(&store[t], a & OFFSET_MASK);
+    WORD value = word_at(&store[t], a & OFFSET_MASK);
+    cache->note_read(a, value);
+    return value;
 }
 
 // set value as the contents of store location (a)
 // (value assumed already appropriately masked)
-inline void Edsac::store_word(ADDR a, WORD value)
+void Edsac::store_word(ADDR a, WORD value)
 {
     int t = tank_num(a);
+    journal->note_write(a, word_at(&store[t], a & OFFSET_MASK));
+    cache->note_write(a);
+    jit->note_write(a);
+    fusion->note_write(a);
+    intrinsics->note_write(a);
     store_word_at(&store[t], a & OFFSET_MASK, value);
 }
 
 // load the multiplicand register with the contents of the (possibly
 // long) word in location (a)
-inline void Edsac::load_mcand(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::load_mcand(ADDR a)
 {
-    adjust_addr(a, lflag);
-    if (lflag) {
-        mcand[0] = get_word(a++);
-    } else { mcand[0] = 0; }
+    adjust_addr<LONG>(a);
+    mcand[0] = LONG ? get_word(a++) : 0;
     mcand[1] = get_word(a);
-    display->update_tube(MCAND);
+    update_tube(MCAND);
 }
 
 //---------- individual order functions ----------
+// (each comes in two versions, LONG being the order's flag, so none has
+// to test the flag as it runs)
+
 // add the (possibly long) number in location (a) to the accumulator
-void Edsac::add(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::add(ADDR a)
 {
-    load_mcand(a, lflag);
-    acc[2] += mcand[0];
-    if (acc[2] > MAX_LOWORD) {
-        acc[2] &= MAX_LOWORD;
-        ++acc[3];
-    }
-    acc[3] += mcand[1];
-    acc[3] &= MAX_HIWORD;
-    display->update_tube(ACC);
+    load_mcand<LONG>(a);
+    add_number(acc.begin(), mcand[0], mcand[1]);
+    update_tube(ACC);
 }
 
 // subtract the (possibly long) number in location (a) from the accumulator
-void Edsac::subtract(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::subtract(ADDR a)
 {
-    load_mcand(a, lflag);
-    acc[2] -= mcand[0];
-    if (acc[2] > MAX_LOWORD) {
-        --acc[3];
-        acc[2] &= MAX_LOWORD;
-    }
-    acc[3] -= mcand[1];
-    acc[3] &= MAX_HIWORD;
-    display->update_tube(ACC);
+    load_mcand<LONG>(a);
+    subtract_number(acc.begin(), mcand[0], mcand[1]);
+    update_tube(ACC);
 }
 
 // load the (possibly long) number in location (a) into the multiplier register
-void Edsac::load_multiplier(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::load_multiplier(ADDR a)
 {
-    adjust_addr(a, lflag);
-    if (lflag) {
-        mplier[0] = get_word(a++);
-    } else { mplier[0] = 0; }
+    adjust_addr<LONG>(a);
+    mplier[0] = LONG ? get_word(a++) : 0;
     mplier[1] = get_word(a);
-    display->update_tube(MPLIER);
+    update_tube(MPLIER);
 }
 
-static void shift_left(WORD [], int);
-static void shift_right(WORD [], int);
-
-// shift the contents of tank t one bit to the left (logical)
-static inline void shift_left(Tank& t)
-    { shift_left(t.begin(), t.end() - t.begin()); }
-
-// shift the contents of tank t one bit to the right (arithmetic)
-static inline void shift_right(Tank& t)
-    { shift_right(t.begin(), t.end() - t.begin()); }
-
-// negate (2's complement) the content of the specified number of
-// words at dest
-static void negate(WORD dest[], int num_words)
-{
-    for (int i = 0; i < num_words; i++) {
-        dest[i] = ~dest[i] & MAX_LOWORD;
-    }
-    ++dest[0];
-    for (int i = 0; i < num_words - 1 and dest[i] > MAX_LOWORD; i++) {
-        dest[i] &= MAX_LOWORD;
-        ++dest[i+1];
-    }
-    dest[num_words - 1] &= MAX_HIWORD;
-}
-
-// add the contents of src to the dest tank
-// (the src array and the dest tank must be the same size)
-static void add_to(WORD src[], Tank& dest)
-{
-    int num_words = dest.end() - dest.begin();
-    for (int i = 0; i < num_words; i++) {
-        dest[i] += src[i];
-        if (dest[i] > MAX_LOWORD and i < num_words - 1) {
-            dest[i] &= MAX_LOWORD;
-            ++dest[i+1];
-        }
-    }
-    dest[num_words - 1] &= MAX_HIWORD;
-}
-
-// subtract the contents of src from the dest tank
-// (the src array and the dest tank must be the same size)
-static void subtract_from(WORD src[], Tank& dest)
-{
-    int num_words = dest.end() - dest.begin();
-    for (int i = 0; i < num_words; i++) {
-        dest[i] -= src[i];
-        if (dest[i] > MAX_LOWORD and i < num_words - 1) {
-            dest[i] &= MAX_LOWORD;
-            --dest[i+1];
-        }
-    }
-    dest[num_words - 1] &= MAX_HIWORD;
-}
-
-// returns the opposite multiplication operation (addition/subtraction)
-// (the type conversions generate no code, but inform the reader -- and
-// the compiler -- that we know what we're doing)
-static inline Edsac::Op_Spec operator not(Edsac::Op_Spec op)
-    { return Edsac::Op_Spec(not bool(op)); }
-
-typedef void (*OPERATION)(WORD [], Tank&);
-OPERATION add_op[] = { add_to, subtract_from };
-
 // multiply the (possibly long) number in location (a) by the number
 // in the multiplier register and add the product to the accumulator
-void Edsac::mult_add(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::mult_add(ADDR a)
 {
-    mult_op(a, lflag, ADDITION);
+    mult_op<LONG>(a, ADDITION);
 }
 
 // multiply the (possibly long) number in location (a) by the number
 // in the multiplier register and subtract the product from the accumulator
-void Edsac::mult_subtract(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::mult_subtract(ADDR a)
 {
-    mult_op(a, lflag, SUBTRACTION);
+    mult_op<LONG>(a, SUBTRACTION);
 }
 
 // transfer the contents of the accumulator to (possibly) long)
 // location (a), and clear the accumulator
-void Edsac::transfer(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::transfer(ADDR a)
 {
-    u_transfer(a, lflag);
+    u_transfer<LONG>(a);
     acc.clear();
-    display->update_tube(ACC);
+    update_tube(ACC);
 }
 
 // transfer the contents of the accumulator to (possibly) long)
 // location (a), but do not clear the accumulator
-void Edsac::u_transfer(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::u_transfer(ADDR a)
 {
-    adjust_addr(a, lflag);
-    if (lflag) { store_word(a++, acc[2]); }
+    adjust_addr<LONG>(a);
+    if (LONG) { store_word(a++, acc[2]); }
     store_word(a, acc[3]);
-    display->update_tube(STORE, a);
+    update_tube(STORE, a);
 }
 
 // "collate" (bitwise and) the (possibly long) number in location (a)
 // with the number in the multiplier register, and add the result into
 // the accumulator
-void Edsac::collate(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::collate(ADDR a)
 {
-    load_mcand(a, lflag);
-    acc[2] += mcand[0] & mplier[0];
-    if (acc[2] > MAX_LOWORD) {
-        acc[2] &= MAX_LOWORD;
-        ++acc[3];
-    }
-    acc[3] += mcand[1] & mplier[1];
-    acc[3] &= MAX_HIWORD;
-    display->update_tube(ACC);
+    load_mcand<LONG>(a);
+    add_number(acc.begin(), mcand[0] & mplier[0], mcand[1] & mplier[1]);
+    update_tube(ACC);
 }
 
 // compute the "control word" value for a shift order
 // (direction must be 'L' or 'R')
 static inline WORD control_word(char direction, ADDR a, bool lflag)
 {
-    return WORD(code(direction)) << (ADDR_BITS + FLAG_BITS)
+    return WORD(code_of(direction)) << (ADDR_BITS + FLAG_BITS)
         | (a << FLAG_BITS) | lflag;
 }
 
-// compute the number of bits to shift, given the "control word"
-// (specified by the position of the rightmost 1-bit in the word)
-static int shift_length(WORD control)
-{
-    int result = 1;
-    while ((control & 0x1) == 0) {
-        ++result;
-        control >>= 1;
-    }
-    return result;
-}
-
-// perform a single-bit arithmetic right shift on a register value with the
-// specified number of words
-static void shift_right(WORD reg[], int num_words)
-{
-    reg[num_words-1] |= (reg[num_words-1] & SIGN_BIT) << 1;
-    WORD next_bit = 0;
-    for (int i = 0; i < num_words; i++) {
-        reg[i] >>= 1;
-        if (i != num_words - 1) {
-            reg[i] |= (reg[i+1] & 0x1) << (LOWORD_BITS - 1);
-        }
-    }
-}
-
 // shift the contents of the accumulator the appropriate number of
 // bits to the right (arithmetic)
-void Edsac::rshift(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::rshift(ADDR a)
 {
-    int nbits = shift_length(control_word('R', a, lflag));
+    int nbits = shift_length(control_word('R', a, LONG));
     for (int i = 0; i < nbits; i++) {
-        shift_right(acc);
+        shift_right(acc.begin(), 4);
     }
-    display->update_tube(ACC);
-}
-
-// perform a single-bit left shift on a register value with the
-// specified number of words
-static void shift_left(WORD reg[], int num_words)
-{
-    bool prev_bit = false;
-    for (int i = 0; i < num_words; i++) {
-        reg[i] = (reg[i] << 1) | prev_bit;
-        prev_bit = (reg[i] & (SANDWICH_BIT << 1)) != 0;
-        reg[i] &= MAX_LOWORD;
-    }
-    reg[num_words - 1] &= MAX_HIWORD;
+    update_tube(ACC);
 }
 
 // shift the contents of the accumulator the appropriate number of
 // bits to the left
-void Edsac::lshift(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::lshift(ADDR a)
 {
-    int nbits = shift_length(control_word('L', a, lflag));
+    int nbits = shift_length(control_word('L', a, LONG));
     for (int i = 0; i < nbits; i++) {
-        shift_left(acc);
+        shift_left(acc.begin(), 4);
     }
-    display->update_tube(ACC);
+    update_tube(ACC);
 }
 
 // branch to location (a) if the accumulator contents are greater than
 // or equal to zero
-void Edsac::pos_branch(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::pos_branch(ADDR a)
 {
     if ((acc[3] & SIGN_BIT) == 0) { sct[0] = a; }
 }
 
 // branch to location (a) if the accumulator contents are less than zero
-void Edsac::neg_branch(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::neg_branch(ADDR a)
 {
     if ((acc[3] & SIGN_BIT) != 0) { sct[0] = a; }
 }
 
 // read the next character from the "input tape" and place the code
 // (multiplied by 2⁻¹⁶) in (possibly long) location (a)
-void Edsac::read(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::read(ADDR a)
 {
-    adjust_addr(a, lflag);
-    if (lflag) {
+    adjust_addr<LONG>(a);
+    if (LONG) {
         // lo word gets zero
         store_word(a++, 0);
     }
@@ -543,139 +903,173 @@ void Edsac::read(ADDR a, bool lflag)
         running = false;
         halted = true;
         reset_enabled = (ch == Tape_Reader::ENDFILE);
-        --sct[0]; display->update_tube(SCT);
+        stopped_by = (ch == Tape_Reader::ENDFILE) ? END_OF_TAPE : BAD_CHARACTER;
+        --sct[0]; update_tube(SCT);
         return;
     }
     store_word(a, ch);
-    display->update_tube(STORE, a);
+    update_tube(STORE, a);
 }
 
 // print the character in the five most significant bits of (possibly
 // long) word location (a) on the teleprinter
-void Edsac::print(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::print(ADDR a)
 {
     // hi in odd; lo in even
-    // odd a --> lflag irrelevant (hi bits already in odd loc)
-    // even a --> add lflag to get actual addr
-    if ((a & 0x1) == 0) { a += lflag; }
+    // odd a --> flag irrelevant (hi bits already in odd loc)
+    // even a --> add flag to get actual addr
+    a |= ADDR(LONG);
     char c = (get_word(a) >> (HIWORD_BITS - CHAR_BITS)) & MAX_CHAR;
-    display->output->do_print(c);
+    print_char(c);
     last_printed = c;
-    display->update_tube(ACC);
+    update_tube(ACC);
 }
 
 // place the last printed character in the five most significant bits
 // of the (possibly long) word at location (a)
-void Edsac::print_check(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::print_check(ADDR a)
 {
-    adjust_addr(a, lflag);
-    if (lflag) { store_word(a++, 0); }
+    adjust_addr<LONG>(a);
+    if (LONG) { store_word(a++, 0); }
     store_word(a,last_printed << (ADDR_BITS + FLAG_BITS)); 
-    display->update_tube(STORE, a);
+    update_tube(STORE, a);
 }
 
 // do nothing
-void Edsac::no_op(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::no_op(ADDR a)
 {}
 
 // roundoff accumulator to 34 bits
 // (i.e., add 2⁻³⁵ to the accumulator)
-void Edsac::roundoff(ADDR a, bool lflag)
-{
-    acc[1] += SANDWICH_BIT;
-    if (acc[1] > MAX_LOWORD) {
-        acc[1] &= MAX_LOWORD;
-        if (++acc[2] > MAX_LOWORD) {
-            acc[2] &= MAX_LOWORD;
-            ++acc[3];
-            acc[3] &= MAX_HIWORD;
-        }
-    }
-    display->update_tube(ACC);
+template <bool LONG>
+void Edsac::roundoff(ADDR a)
+{
+    round_off(acc.begin());
+    update_tube(ACC);
 }
 
 // stop the machine and ring the warning bell
-void Edsac::halt(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::halt(ADDR a)
 {
-    if (Settings::stop_bell()) { play_sound(":/Bell.wav"); }
-    display->set_stop_light(true);
+    if (Settings::stop_bell() and not replaying) { play_sound(":/Bell.wav"); }
+    set_stop_light(true);
+    stopped_by = HALT_ORDER;
     reset_enabled = halted = true;
     running = false;
 }
 
 // invalid order -- stop the machine
-void Edsac::invalid(ADDR a, bool lflag)
+template <bool LONG>
+void Edsac::invalid(ADDR a)
 {
     halted = true;
     reset_enabled = running = false;
+    stopped_by = INVALID_ORDER;
 }
 //---------- end of individual order functions ----------
 
 // multiply the (possibly long) number in location (a) by the number
 // in the multiplier register and perform the specified operation wrt
 // the accumulator (helper function for mult_add/mult_subtract)
-void Edsac::mult_op(ADDR a, bool lflag, Op_Spec op)
+template <bool LONG>
+void Edsac::mult_op(ADDR a, Op_Spec op)
 {
-    load_mcand(a, lflag);
-    LONGWORD x_mcand = long_word(mcand[0], mcand[1]);
-    if ((x_mcand & LONG_SIGN_BIT) != 0) {
-        x_mcand = -x_mcand & MAX_LONGWORD;
-        op = not op;
-    }
-    WORD x_mplier[4] = {};
-    // multiplier to use is value shifted left twice
-    x_mplier[0] = mplier[0]; x_mplier[1] = mplier[1];
-    if ((x_mplier[1] & SIGN_BIT) != 0) {
-        negate(x_mplier, 2);
-        op = not op;
-    }
-    shift_left(x_mplier, 4); shift_left(x_mplier, 4);
-    for (int i = 0; i < 35; i++) {
-        if ((x_mcand & 0x1) != 0) {
-            // add to accumulator
-            add_op[op](x_mplier, acc);
-            //display->update_tube(ACC);  // exec too fast for this
-        }
-        x_mcand >>= 1;
-        shift_left(x_mplier, 4);
-    }
-    display->update_tube(ACC);
+    load_mcand<LONG>(a);
+    multiply(acc.begin(), mcand.begin(), mplier.begin(), op == SUBTRACTION);
+    update_tube(ACC);
     mcand.clear();
-    display->update_tube(MCAND);
+    update_tube(MCAND);
+}
+
+// turn the stop light on (or off)
+void Edsac::set_stop_light(bool on)
+{
+    stop_light = on;
+    if (not quiet) { display->set_stop_light(on); }
+}
+
+// advance machine time (and the display clock, unless quiet)
+void Edsac::advance_clock(TICKS t)
+{
+    sim_time += t;
+    if (not quiet) { display->clock->sync(sim_time); }
 }
 
-// jump table for Edsac order functions
+// send character c to the teleprinter, remembering it for run_to_output
+void Edsac::print_char(char c)
+{
+    static const int MAX_TRANSCRIPT = 4096;
+
+    if (replaying) { return; }      // already printed the first time
+    cache->note_print(c);
+    if (print_hook) { print_hook(c); }
+    if (not Settings::headless()) { display->output->do_print(c, quiet); }
+
+    QChar qc = Teleprinter::translate(c, transcript_shift);
+    if (qc == 'n') { transcript += '\n'; }
+    else if (not qc.isLower()) { transcript += qc; }
+    else { return; }        // other control chars leave no trace
+    ++chars_printed;
+    if (transcript.size() > 2 * MAX_TRANSCRIPT) {
+        transcript.remove(0, transcript.size() - MAX_TRANSCRIPT);
+    }
+}
+
+// bring the display up to date after running quietly
+void Edsac::refresh()
+{
+    if (Settings::headless()) { return; }
+    display->clock->sync(sim_time);
+    display->set_stop_light(stop_light);
+    display->update();
+}
+
+// jump table for Edsac order functions: both versions of each, short
+// then long, in function code order (so the index is the order's top
+// five bits and its flag)
+#define VERSIONS(f) &Edsac::f<false>, &Edsac::f<true>
 const Edsac::EXEC_FUNC Edsac::optab[] = {
-    &Edsac::invalid,            // P
-    &Edsac::invalid,            // Q
-    &Edsac::invalid,            // W
-    &Edsac::pos_branch,         // E
-    &Edsac::rshift,             // R
-    &Edsac::transfer,           // T
-    &Edsac::roundoff,           // Y
-    &Edsac::u_transfer,         // U
-    &Edsac::read,               // I
-    &Edsac::print,              // O
-    &Edsac::invalid,            // J
-    &Edsac::invalid,            // pi
-    &Edsac::subtract,           // S
-    &Edsac::halt,               // Z
-    &Edsac::invalid,            // K
-    &Edsac::invalid,            // erase
-    &Edsac::invalid,            // blank
-    &Edsac::print_check,        // F
-    &Edsac::invalid,            // theta
-    &Edsac::invalid,            // D
-    &Edsac::invalid,            // phi
-    &Edsac::load_multiplier,    // H
-    &Edsac::mult_subtract,      // N
-    &Edsac::invalid,            // M
-    &Edsac::invalid,            // delta
-    &Edsac::lshift,             // L
-    &Edsac::no_op,              // X
-    &Edsac::neg_branch,         // G
-    &Edsac::add,                // A
-    &Edsac::invalid,            // B
-    &Edsac::collate,            // C
-    &Edsac::mult_add            // V
+    VERSIONS(invalid),          // P
+    VERSIONS(invalid),          // Q
+    VERSIONS(invalid),          // W
+    VERSIONS(pos_branch),       // E
+    VERSIONS(rshift),           // R
+    VERSIONS(transfer),         // T
+    VERSIONS(roundoff),         // Y
+    VERSIONS(u_transfer),       // U
+    VERSIONS(read),             // I
+    VERSIONS(print),            // O
+    VERSIONS(invalid),          // J
+    VERSIONS(invalid),          // pi
+    VERSIONS(subtract),         // S
+    VERSIONS(halt),             // Z
+    VERSIONS(invalid),          // K
+    VERSIONS(invalid),          // erase
+    VERSIONS(invalid),          // blank
+    VERSIONS(print_check),      // F
+    VERSIONS(invalid),          // theta
+    VERSIONS(invalid),          // D
+    VERSIONS(invalid),          // phi
+    VERSIONS(load_multiplier),  // H
+    VERSIONS(mult_subtract),    // N
+    VERSIONS(invalid),          // M
+    VERSIONS(invalid),          // delta
+    VERSIONS(lshift),           // L
+    VERSIONS(no_op),            // X
+    VERSIONS(neg_branch),       // G
+    VERSIONS(add),              // A
+    VERSIONS(invalid),          // B
+    VERSIONS(collate),          // C
+    VERSIONS(mult_add)          // V
 };
+#undef VERSIONS
+
+// the kernels Microbench times on their own, made here for it
+template void Edsac::load_mcand<false>(ADDR a);
+template void Edsac::load_mcand<true>(ADDR a);
+template void Edsac::mult_op<false>(ADDR a, Op_Spec op);
+template void Edsac::mult_op<true>(ADDR a, Op_Spec op);
@@ -5,19 +5,52 @@
 #ifndef EDSAC_H
 #define EDSAC_H
 
+#include <QElapsedTimer>
 #include <QObject>
+#include <QString>
+
+#include <deque>
+#include <functional>
+#include <vector>
 
 #include "attributes.h"
+#include "display.h"
+#include "output.h"
 #include "tank.h"
 
+class Batch;
+class Fusion;
+class Intrinsics;
+class Jit;
+class Journal;
+class Load_Cache;
 class Tape_Reader;
+class Translator;
+class Verifier;
 
 class Edsac : public QObject
 {
+private:
+    friend class Batch;
+    friend class Fusion;
+    friend class Intrinsics;
+    friend class Jit;
+    friend class Journal;
+    friend class Load_Cache;
+    friend class Loader;
+    friend class Microbench;
+    friend class Translator;
+    friend class Verifier;
 public:
     // operations used when multiplying
     enum Op_Spec { ADDITION = 0, SUBTRACTION = 1 };
 
+    // why the machine last stopped
+    enum Stop_Reason {
+        NOT_STOPPED, HALT_ORDER, CONDITION, INVALID_ORDER,
+        END_OF_TAPE, BAD_CHARACTER, STOPPED, HUNG
+    };
+
     Edsac();
 
     void clear();
@@ -28,6 +61,54 @@ public:
     void kill();
 
     void dial_digit(unsigned i);
+    void queue_dial(const QString& digits);
+
+    // load the initial orders and mount the given text as the tape
+    // (for runs without an edit window); reading the tape in at once
+    // stops short of max_orders, leaving the rest to the initial orders
+    void load_program(const QString& tape, uint64_t max_orders = ~0ull);
+
+    // run at full speed (no display updates) until the condition is
+    // met or the machine stops; each returns the number of orders run
+    unsigned long run_orders(unsigned long n);
+    unsigned long run_to_address(ADDR a);
+    unsigned long run_to_print();
+    unsigned long run_to_output(const QString& text);
+    unsigned long run_to_stop();
+    unsigned long run_to_program();     // (till the initial orders end)
+
+    // compare library routines run as host code with interpreting them
+    // over n random inputs (returns the number of mismatches)
+    unsigned long check_intrinsics(unsigned n);
+
+    // run the mounted tape (at most n orders), or n random programs,
+    // doing each step both with the fast paths and by interpreting
+    // every order, and report the first difference (returns # found)
+    unsigned long verify_tape(uint64_t n);
+    unsigned long verify_random(unsigned n);
+
+    // run the mounted tape until the program proper starts, then write
+    // it (from the named tape) to file_name as a C++ program that runs
+    // it natively (false if that can't be done)
+    bool translate(const QString& file_name, const QString& tape_name);
+
+    // undo the last order (or run backwards until sequence control = a)
+    void step_back();
+    void run_back_to(ADDR a);
+
+    Stop_Reason stop_reason() const { return stopped_by; }
+
+    // simulated time (incl. loading) and # of orders executed so far
+    TICKS time() const { return sim_time; }
+    uint64_t orders_executed() const { return order_count; }
+
+    // pairs of orders done as one step, by pattern
+    const Fusion *fused_pairs() const { return fusion; }
+
+    bool is_running() const { return running; }
+
+    // called with every character printed (used when running headless)
+    void set_print_hook(std::function<void(char)> f) { print_hook = f; }
 
     Tank *accumulator() { return &acc; }
     Tank *multiplicand() { return &mcand; }
@@ -35,49 +116,87 @@ public:
     Tank *sc_tank() { return &sct; }
     Tank *order_tank() { return &order; }
     Tank *store_tank(unsigned n = 0) { return &store[n]; }
+
+    // copy of the whole store (for post-mortem dumps)
+    std::vector<WORD> store_image() const;
 private:
-    typedef void (Edsac::*EXEC_FUNC)(ADDR, bool);
+    typedef void (Edsac::*EXEC_FUNC)(ADDR);
 
     // ensure long word address is even
     static void adjust_addr(ADDR& a, bool lflag)
         { a &= ~ADDR(lflag); }
+    template <bool LONG> static void adjust_addr(ADDR& a)
+        { a &= ~ADDR(LONG); }
 
     void execute();
     void exec_order();
+    // true if a fast path may run n orders as one step from (at), passing
+    // through locations at + 1 to at + span - 1 (run_until's bound)
+    bool within_bounds(ADDR at, uint64_t n, ADDR span) const
+    {   ADDR d = (stop_at - at) & MAX_ADDR;
+        return order_count + n <= order_limit
+               and (stop_at == NO_STOP or d == 0 or d >= span);
+    }
+    void check_loop(ADDR at, char func);
+    void hang(ADDR at);
+    void restart_pacer();
+    void pace(TICKS t);
+    unsigned long run_until(std::function<bool()> done,
+                            uint64_t end = NO_END, ADDR stop = NO_STOP);
+    unsigned long run_quietly(std::function<bool()> done);
+    void show_progress(uint64_t orders, qint64 msecs);
     void clear_regs()
         { acc.clear(); mcand.clear(); mplier.clear(); sct.clear();
           order.clear(); }
+    void prepare();
     void load_initial_orders();
     WORD get_word(ADDR a);
     void store_word(ADDR a, WORD value);
-    void load_mcand(ADDR a, bool lflag);
-
-    // operation functions
-    void add(ADDR a, bool lflag);               // A
-    void subtract(ADDR a, bool lflag);          // S
-    void load_multiplier(ADDR a, bool lflag);   // H
-    void mult_add(ADDR a, bool lflag);          // V
-    void mult_subtract(ADDR a, bool lflag);     // N
-    void transfer(ADDR a, bool lflag);          // T
-    void u_transfer(ADDR a, bool lflag);        // U
-    void collate(ADDR a, bool lflag);           // C
-    void rshift(ADDR a, bool lflag);            // R
-    void lshift(ADDR a, bool lflag);            // L
-    void pos_branch(ADDR a, bool lflag);        // E
-    void neg_branch(ADDR a, bool lflag);        // F
-    void read(ADDR a, bool lflag);              // I
-    void print(ADDR a, bool lflag);             // O
-    void print_check(ADDR a, bool lflag);       // F
-    void no_op(ADDR a, bool lflag);             // X
-    void roundoff(ADDR a, bool lflag);          // Y
-    void halt(ADDR a, bool lflag);              // Z
-    void invalid(ADDR a, bool lflag);           // everything else
+    template <bool LONG> void load_mcand(ADDR a);
+    void enter_digit(unsigned n);
+    bool dial_queued();
+
+    // operation functions, one for short and one for long operands
+    // (LONG is the order's flag)
+    template <bool LONG> void add(ADDR a);              // A
+    template <bool LONG> void subtract(ADDR a);         // S
+    template <bool LONG> void load_multiplier(ADDR a);  // H
+    template <bool LONG> void mult_add(ADDR a);         // V
+    template <bool LONG> void mult_subtract(ADDR a);    // N
+    template <bool LONG> void transfer(ADDR a);         // T
+    template <bool LONG> void u_transfer(ADDR a);       // U
+    template <bool LONG> void collate(ADDR a);          // C
+    template <bool LONG> void rshift(ADDR a);           // R
+    template <bool LONG> void lshift(ADDR a);           // L
+    template <bool LONG> void pos_branch(ADDR a);       // E
+    template <bool LONG> void neg_branch(ADDR a);       // F
+    template <bool LONG> void read(ADDR a);             // I
+    template <bool LONG> void print(ADDR a);            // O
+    template <bool LONG> void print_check(ADDR a);      // F
+    template <bool LONG> void no_op(ADDR a);            // X
+    template <bool LONG> void roundoff(ADDR a);         // Y
+    template <bool LONG> void halt(ADDR a);             // Z
+    template <bool LONG> void invalid(ADDR a);          // everything else
 
     // helper func for mult_add/mult_subtract
-    void mult_op(ADDR a, bool lflag, Op_Spec op);
+    template <bool LONG> void mult_op(ADDR a, Op_Spec op);
+
+    // do order func (with the given flag) on address a
+    void obey(char func, ADDR a, bool lflag)
+        { (this->*optab[(func << FLAG_BITS) | lflag])(a); }
+
+    // display helpers (display work is deferred while running quietly)
+    void update_tube(Short_Tank st, ADDR a = ALL_LINES)
+        { if (not quiet) { display->update_tube(st, a); } }
+    void set_stop_light(bool on);
+    void advance_clock(TICKS t);
+    void print_char(char c);
+    void refresh();
 
-    // jump table
+    // jump table (indexed by function and flag, as the order's top five
+    // bits and bottom bit), and time taken by each order
     static const EXEC_FUNC optab[];
+    static const TICKS timings[];
 
     // registers & store
     Tank acc;
@@ -93,10 +212,49 @@ private:
     volatile bool halted = true;        // may be redundant
     volatile bool reset_enabled = false;
     volatile bool loading = false;
+    bool quiet = false;                 // suppress display updates
+    bool replaying = false;             // regenerating journal records
+    bool skip_loops = false;            // fast-forward through idle loops
+    bool interpret_only = false;        // no fast paths (to verify them)
+    ADDR last_loop = ~0;                // last backward branch taken
+    Stop_Reason stopped_by = NOT_STOPPED;
 
     Tape_Reader *input;
-    TICKS excess = 0;       // for adjusting "real time" calculations
+    Journal *journal;
+    Load_Cache *cache;
+    Intrinsics *intrinsics;
+    Jit *jit;
+    Fusion *fusion;
+    Verifier *verifier;
+    ADDR initial_orders_end = 0;        // first location after them
     char last_printed = 0;
+    std::deque<unsigned> dial_queue;    // digits still to be dialed
+    unsigned dial_turn = 0;     // bumped per dial, and by stop() and kill()
+
+    // for keeping simulated time in step with real time
+    QElapsedTimer pace_timer;
+    uint64_t pace_ticks = 0;    // simulated time since pace_timer started
+    int pace_speed = 0;         // speed pace_timer started at
+
+    // machine time (the display clock samples this)
+    TICKS sim_time = 0;
+    uint64_t order_count = 0;
+
+    // how far the fast paths may go while running to a bound: to no more
+    // than order_limit orders, and not through location stop_at
+    static const uint64_t NO_END = ~uint64_t(0);
+    static const ADDR NO_STOP = ~ADDR(0);
+    uint64_t order_limit = NO_END;
+    ADDR stop_at = NO_STOP;
+
+    // deferred display state (while quiet)
+    bool stop_light = false;
+
+    // recent output (for run_to_output)
+    std::function<void(char)> print_hook;
+    QString transcript;
+    unsigned long chars_printed = 0;
+    Teleprinter::Shift_Mode transcript_shift = Teleprinter::LETTERS;
 };
 
 extern Edsac *edsac;    // single simulator object
@@ -9,12 +9,18 @@
 #include <QSound>
 #include <QString>
 
+#include "settings.h"
+
 namespace Error {
 
     // report internal error
     inline
     QMessageBox::StandardButton internal_error(const QString& msg)
-    {   return QMessageBox::critical(nullptr, "Internal Error", msg,
+    {   if (Settings::headless()) {     // no windows for message box
+            qWarning("Internal Error: %s", qPrintable(msg));
+            return QMessageBox::Abort;
+        }
+        return QMessageBox::critical(nullptr, "Internal Error", msg,
             QMessageBox::Abort | QMessageBox::Ignore,
             QMessageBox::Abort);
     }
@@ -22,10 +28,16 @@ namespace Error {
     // report "normal" error
     inline
     QMessageBox::StandardButton error(const QString& msg)
-        { return QMessageBox::critical(nullptr, "Error", msg); }
+    {   if (Settings::headless()) {
+            qWarning("Error: %s", qPrintable(msg));
+            return QMessageBox::Ok;
+        }
+        return QMessageBox::critical(nullptr, "Error", msg);
+    }
 
     // using "play_sound" causes extra, unnecessary dependencies
-    inline void beep() { QSound::play(":/Beep.wav"); }
+    inline void beep()
+        { if (not Settings::headless()) { QSound::play(":/Beep.wav"); } }
 
 };
 
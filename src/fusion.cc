@@ -0,0 +1,175 @@
+/*
+ * fusion.cc -- definitions for Fusion class
+ *              (common pairs of orders done as one step)
+ */
+#include <algorithm>
+
+#include "fusion.h"
+
+#include "arith.h"
+#include "cache.h"
+#include "codes.h"
+#include "edsac.h"
+#include "settings.h"
+#include "tank.h"
+
+using Codes::code_of;       // punch code for given letter
+
+static const char A = code_of('A'), S = code_of('S'), H = code_of('H'),
+                  V = code_of('V'), N = code_of('N'), T = code_of('T'),
+                  U = code_of('U'), R = code_of('R'), L = code_of('L'),
+                  E = code_of('E'), G = code_of('G');
+
+// the fields of an order
+static inline char func_of(WORD w) { return w >> (ADDR_BITS + FLAG_BITS); }
+static inline ADDR addr_of(WORD w) { return (w >> FLAG_BITS) & MAX_ADDR; }
+static inline bool flag_of(WORD w) { return (w & MAX_FLAG) != 0; }
+
+Fusion::Fusion(Edsac *e)
+    : edsac(e), decoded(STORE_WORDS, uint8_t(UNKNOWN))
+{}
+
+// do the pair of orders at (at), if it can be fused (true if so), leaving
+// everything as the two would one after the other
+// (not while the journal or the load cache must see every order)
+bool Fusion::fuse(ADDR at)
+{
+    if (Settings::journal_depth() != 0 or edsac->cache->is_watching()) {
+        return false;
+    }
+    uint8_t& p = decoded[at % STORE_WORDS];
+    if (p == UNKNOWN) { p = decode(at); }
+    if (p == NONE or not edsac->within_bounds(at, 2, 2)) { return false; }
+    Pattern pattern = Pattern(p);
+
+    auto word = [this](ADDR a)
+        { return word_at(&edsac->store[tank_num(a)], a & OFFSET_MASK); };
+    ADDR second_at = (at + 1) & MAX_ADDR;
+    WORD first = word(at), second = word(second_at);
+    ADDR a1 = addr_of(first), a2 = addr_of(second);
+    bool l1 = flag_of(first), l2 = flag_of(second);
+    char f1 = func_of(first), f2 = func_of(second);
+    Tank& acc = edsac->acc;
+
+    edsac->halted = false;
+    edsac->sct[0] = (at + 2) & MAX_ADDR;
+    edsac->order[0] = second;
+    edsac->order_count += 2;    // (before check_loop() counts any more)
+    switch (pattern) {
+    case MULTIPLY: {    // (the multiplicand is left clear, as V or N does)
+        Edsac::adjust_addr(a1, l1);
+        edsac->mplier[0] = l1 ? word(a1++) : 0;
+        edsac->mplier[1] = word(a1);
+        Edsac::adjust_addr(a2, l2);
+        WORD low = l2 ? word(a2++) : 0;
+        multiply_numbers(acc.begin(), long_word(low, word(a2)),
+            long_word(edsac->mplier[0], edsac->mplier[1]), f2 == N);
+        edsac->mcand.clear();
+        edsac->update_tube(MPLIER);
+        edsac->update_tube(MCAND);
+        edsac->update_tube(ACC);
+        break;
+    }
+    case STORE_LOAD:    // (the accumulator is clear when the A adds to it)
+        edsac->obey(U, a1, l1);
+        Edsac::adjust_addr(a2, l2);
+        edsac->mcand[0] = l2 ? word(a2++) : 0;
+        edsac->mcand[1] = word(a2);
+        acc[0] = acc[1] = 0;
+        acc[2] = edsac->mcand[0];
+        acc[3] = edsac->mcand[1] & MAX_HIWORD;
+        edsac->update_tube(MCAND);
+        edsac->update_tube(ACC);
+        break;
+    case ADD_KEEP:
+        Edsac::adjust_addr(a1, l1);
+        edsac->mcand[0] = l1 ? word(a1++) : 0;
+        edsac->mcand[1] = word(a1);
+        add_number(acc.begin(), edsac->mcand[0], edsac->mcand[1]);
+        Edsac::adjust_addr(a2, l2);
+        if (l2) { edsac->store_word(a2++, acc[2]); }
+        edsac->store_word(a2, acc[3]);
+        edsac->update_tube(MCAND);
+        edsac->update_tube(ACC);
+        edsac->update_tube(STORE, a2);
+        break;
+    case SHIFT_STORE: { // (only the upper half survives the T)
+        // the accumulator's top 53 bits, shifted at once (a shift is never
+        // longer than 15 places, so all the bits needed are there)
+        int n = shift_length(first);
+        LONGWORD high;
+        if (f1 == L) {
+            LONGWORD top =
+                (long_word(acc[2], acc[3]) << LOWORD_BITS) | acc[1];
+            high = (top << n) >> LOWORD_BITS;
+        } else {
+            high = LONGWORD(sign_extend(acc[2], acc[3]) >> n);
+        }
+        high &= MAX_LONGWORD;
+        acc[2] = high & MAX_LOWORD;
+        acc[3] = high >> LOWORD_BITS;
+        edsac->obey(U, a2, l2);
+        acc.clear();
+        edsac->update_tube(ACC);
+        break;
+    }
+    case TEST:
+        edsac->obey(f1, a1, l1);
+        if (((acc[3] & SIGN_BIT) != 0) == (f2 == G)) { edsac->sct[0] = a2; }
+        if (edsac->running and edsac->sct[0] <= second_at) {
+            edsac->check_loop(second_at, f2);
+        }
+        break;
+    default:
+        break;
+    }
+    edsac->update_tube(SCT);
+    edsac->update_tube(ORDER);
+    ++counts[pattern];
+
+    TICKS t = Edsac::timings[int(f1)] + Edsac::timings[int(f2)];
+    edsac->advance_clock(t);
+    edsac->pace(t);
+    return true;
+}
+
+// forget every pair (the store has been changed wholesale)
+void Fusion::flush()
+{
+    std::fill(decoded.begin(), decoded.end(), uint8_t(UNKNOWN));
+}
+
+// name of a pattern, by its orders
+const char *Fusion::name(Pattern p)
+{
+    static const char *const NAMES[NUM_PATTERNS] =
+        { "H+V/N", "T+A", "A+U", "R/L+T", "A/S+E/G" };
+    return NAMES[p];
+}
+
+// the pattern of the pair of orders starting at (at), or NONE
+uint8_t Fusion::decode(ADDR at)
+{
+    WORD first = word_at(&edsac->store[tank_num(at)], at & OFFSET_MASK);
+    ADDR next = (at + 1) & MAX_ADDR;
+    WORD second = word_at(&edsac->store[tank_num(next)], next & OFFSET_MASK);
+    char f1 = func_of(first), f2 = func_of(second);
+
+    if (f1 == H and (f2 == V or f2 == N)) { return MULTIPLY; }
+    if (f1 == A and f2 == U) { return ADD_KEEP; }
+    if ((f1 == R or f1 == L) and f2 == T) { return SHIFT_STORE; }
+    if ((f1 == A or f1 == S) and (f2 == E or f2 == G)) { return TEST; }
+    if (f1 == T and f2 == A) {
+        // not if the T writes the A itself (that A is the one obeyed)
+        ADDR a = addr_of(first);
+        bool lflag = flag_of(first);
+        Edsac::adjust_addr(a, lflag);
+        if (a % STORE_WORDS == next % STORE_WORDS
+            or (lflag and (a + 1) % STORE_WORDS == next % STORE_WORDS))
+        {
+            return NONE;
+        }
+        return STORE_LOAD;
+    }
+    return NONE;
+}
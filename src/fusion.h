@@ -0,0 +1,68 @@
+/*
+ * fusion.h -- declarations for Fusion class
+ *             (common pairs of orders done as one step)
+ */
+#ifndef FUSION_H
+#define FUSION_H
+
+#include <cstdint>
+#include <vector>
+
+#include "attributes.h"
+
+class Edsac;
+
+// Recognizes pairs of orders that programs use again and again -- H then
+// V or N (multiply), T then A (store one number, fetch the next), A then
+// U (add and keep), R or L then T (scale and store), and A or S then E or
+// G (the test closing a loop) -- and does each pair as one step, with a
+// single dispatch and without the intermediate work that nothing could
+// see: the order tank, sequence control, and tubes between the two, the
+// accumulator a T clears just before an A reloads it, or the shifting of
+// its low half just before a T discards it; the multiplication itself is
+// done at once by host arithmetic, not bit by bit.  The pattern at each
+// store location is decoded when first reached and kept until either
+// order of the pair is written, so a program that modifies its own
+// orders is decoded afresh.
+class Fusion
+{
+public:
+    enum Pattern {
+        MULTIPLY,       // H, V/N
+        STORE_LOAD,     // T, A
+        ADD_KEEP,       // A, U
+        SHIFT_STORE,    // R/L, T
+        TEST,           // A/S, E/G
+        NUM_PATTERNS
+    };
+
+    Fusion(Edsac *e);
+
+    // if the orders at (at) -- where sequence control is -- are a pair
+    // that can be fused, do both (true if so)
+    bool run(ADDR at)
+        { return decoded[at % STORE_WORDS] != NONE and fuse(at); }
+
+    // forget the pairs that include store location a (it has been
+    // written), or every pair (the store has been changed wholesale)
+    void note_write(ADDR a)
+    {   decoded[a % STORE_WORDS] = UNKNOWN;
+        decoded[(a + STORE_WORDS - 1) % STORE_WORDS] = UNKNOWN;
+    }
+    void flush();
+
+    // # times each pattern has been run, and its name (as "H+V/N")
+    uint64_t count(Pattern p) const { return counts[p]; }
+    static const char *name(Pattern p);
+private:
+    static const uint8_t UNKNOWN = NUM_PATTERNS + 1, NONE = NUM_PATTERNS;
+
+    bool fuse(ADDR at);
+    uint8_t decode(ADDR at);
+
+    Edsac *edsac;
+    std::vector<uint8_t> decoded;   // pattern starting at each location
+    uint64_t counts[NUM_PATTERNS] = {};
+};
+
+#endif
@@ -0,0 +1,371 @@
+/*
+ * headless.cc -- definitions for Headless namespace
+ *                (running a tape from the command line, without windows)
+ */
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "headless.h"
+
+#include "batch.h"
+#include "bench.h"
+#include "edsac.h"
+#include "fusion.h"
+#include "microbench.h"
+#include "output.h"
+#include "postmortem.h"
+#include "settings.h"
+#include "sweep.h"
+
+static const char HEADLESS_FLAG[] = "--headless";
+
+// true if the command line asks for a headless run
+bool Headless::requested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++) {
+        if (QString(argv[i]) == HEADLESS_FLAG) { return true; }
+    }
+    return false;
+}
+
+// describe why the machine stopped
+const char *Headless::describe(int why)
+{
+    switch (why) {
+        case Edsac::NOT_STOPPED:    return "still running";
+        case Edsac::HALT_ORDER:     return "stopped by Z order";
+        case Edsac::CONDITION:      return "run-until condition met";
+        case Edsac::INVALID_ORDER:  return "invalid order";
+        case Edsac::END_OF_TAPE:    return "end of input tape";
+        case Edsac::BAD_CHARACTER:  return "invalid input character";
+        case Edsac::STOPPED:        return "stopped";
+        case Edsac::HUNG:           return "hung in a loop";
+    }
+    return "unknown";
+}
+
+// print the summary of a run that stopped for the given reason
+static void summarize(FILE *f, uint64_t count, Edsac::Stop_Reason why,
+                      ADDR at, TICKS t)
+{
+    fprintf(f, "\n%llu orders executed; %s at %u\n",
+        (unsigned long long)count, Headless::describe(why), unsigned(at));
+    fprintf(f, "simulated time %llu.%04llu seconds\n",
+        (unsigned long long)(t / 10000), (unsigned long long)(t % 10000));
+}
+
+// true if a run that stopped for the given reason succeeded
+static bool succeeded(Edsac::Stop_Reason why)
+{
+    return why == Edsac::HALT_ORDER or why == Edsac::CONDITION
+        or why == Edsac::HUNG;
+}
+
+// run the loaded tape once for each sequence of digits to dial, a batch
+// of machines at a time in lockstep (at most limit orders each), and
+// print each run's output and summary in turn; returns the exit status
+static int run_each(const QStringList& dials, uint64_t limit)
+{
+    int status = 0;
+    uint64_t together = 0, alone = 0;
+    for (int first = 0; first < dials.size(); first += Batch::LANES) {
+        int n = std::min(dials.size() - first, int(Batch::LANES));
+        Batch batch(edsac, n);
+        for (int i = 0; i < n; i++) {
+            batch.queue_dial(i, dials[first + i]);
+        }
+        batch.run(limit);
+        for (int i = 0; i < n; i++) {
+            Edsac::Stop_Reason why = Edsac::Stop_Reason(batch.stop_reason(i));
+            printf("--- dial %s ---\n", qPrintable(dials[first + i]));
+            fputs(qPrintable(batch.output(i)), stdout);
+            summarize(stdout, batch.orders_executed(i), why,
+                      batch.stopped_at(i), batch.time(i));
+            if (not succeeded(why)) { status = 1; }
+        }
+        together += batch.lockstep_orders();
+        alone += batch.single_orders();
+    }
+    fflush(stdout);
+    fprintf(stderr, "%d runs; %llu of %llu orders run in lockstep\n",
+        dials.size(), (unsigned long long)together,
+        (unsigned long long)(together + alone));
+    return status;
+}
+
+// run the tape named on the command line; returns the exit status
+// (teleprinter output goes to stdout, a summary to stderr)
+int Headless::run(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("Edsac Simulator");
+    QCoreApplication::setApplicationName("qedsac");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Run an EDSAC tape without windows.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("tape", "Program tape to run.");
+    QCommandLineOption headless(QString(HEADLESS_FLAG).mid(2),
+        "Run without windows.");
+    QCommandLineOption initial_orders("initial-orders",
+        "Initial orders to load (1 or 2).", "n");
+    QCommandLineOption simulate_loader("simulate-loader",
+        "Run Initial Orders 2 order by order instead of loading natively.");
+    QCommandLineOption no_cache("no-cache",
+        "Always load the tape (do not use or save a loaded image).");
+    QCommandLineOption intrinsics("intrinsics",
+        "Run standard library routines as host code.");
+    QCommandLineOption jit("jit",
+        "Run straight-line runs of orders as native code (x86-64 only).");
+    QCommandLineOption fuse("fuse",
+        "Do common pairs of orders as one step, and report how often each"
+        " pair was fused.");
+    QCommandLineOption check_intrinsics("check-intrinsics",
+        "Compare library routines run as host code with interpreting them,"
+        " over n random inputs each (no tape needed).", "n");
+    QCommandLineOption verify("verify",
+        "Run each step both with the fast paths and by interpreting every"
+        " order, stopping at the first difference (the fast paths are those"
+        " given by --intrinsics, --jit, and --fuse, or all three if none"
+        " is).");
+    QCommandLineOption verify_random("verify-random",
+        "Verify the fast paths as --verify does over n random programs"
+        " (no tape needed).", "n");
+    QCommandLineOption microbench("microbench",
+        "Time the engine's arithmetic, store, and dispatch kernels one at a"
+        " time, n operations each on random operands, printing nanoseconds"
+        " an operation (no tape needed).", "n");
+    QCommandLineOption translate("translate",
+        "Instead of running the tape, write the loaded program to file as"
+        " C++ that runs it natively (compile it with translated.h, arith.h,"
+        " and codes.h from the qedsac sources).", "file");
+    QCommandLineOption post_mortem("post-mortem",
+        "After the run, print the store as post-mortem routine PMn would"
+        " (0-5), from first to last (default: the whole store).",
+        "n[:first[-last]]");
+    QCommandLineOption dial("dial",
+        "Digits to dial, one each time the program stops at a Z order.",
+        "digits");
+    QCommandLineOption dial_each("dial-each",
+        "Run the tape once for each comma-separated list of digits to dial,"
+        " several runs at a time in lockstep, printing each run's output"
+        " and summary in turn.", "list");
+    QCommandLineOption sweep("sweep",
+        "Run the tape once for each value of placeholder {name} in it (and"
+        " in any --data), printing a table of the runs' output; m..n stands"
+        " for the integers m to n.  Given for several placeholders, every"
+        " combination is run.", "name=v1,v2,...");
+    QCommandLineOption zip("zip",
+        "Run the --sweep values in step (the first of each, then the"
+        " second, and so on) instead of every combination.");
+    QCommandLineOption data("data",
+        "Data tape to follow the program tape (for --sweep).", "file");
+    QCommandLineOption threads("threads",
+        "Threads to run --sweep variants on (default: one per processor).",
+        "n");
+    QCommandLineOption bench("bench",
+        "Instead of running the tape once, load and run it under each"
+        " engine configuration in turn (interpreted, native loader, fusion,"
+        " intrinsics, JIT, and all of them), printing the load time, orders"
+        " a second, and ratio of simulated to real time of each.");
+    QCommandLineOption expect("expect",
+        "Teleprinter output each --bench run should produce.", "file");
+    QCommandLineOption orders("orders",
+        "Run n orders in all (counting those that read the tape in).", "n");
+    QCommandLineOption until_address("until-address",
+        "Run until sequence control reaches address a.", "a");
+    QCommandLineOption until_print("until-print",
+        "Run until the next order is an O order.");
+    QCommandLineOption until_output("until-output",
+        "Run until the output ends with text.", "text");
+    parser.addOptions({ headless, initial_orders, simulate_loader, no_cache,
+                        intrinsics, jit, fuse, check_intrinsics, verify,
+                        verify_random, microbench, translate, post_mortem,
+                        dial, dial_each, sweep, zip, data, threads, bench,
+                        expect, orders, until_address, until_print,
+                        until_output });
+    parser.process(app);
+
+    QStringList args = parser.positionalArguments();
+    if (args.size() != 1 and not parser.isSet(check_intrinsics)
+        and not parser.isSet(verify_random) and not parser.isSet(microbench))
+    {
+        fprintf(stderr, "qedsac: exactly one tape file expected\n");
+        return 2;
+    }
+
+    // user's settings, less anything that needs windows or speakers
+    Settings::load_settings();
+    Settings::set_headless(true);
+    Settings::set_sound(false);
+    Settings::set_teleprinter_sound(false);
+    Settings::set_stop_bell(false);
+    Settings::set_real_time(false);
+    Settings::set_journal_depth(0);     // (nothing can step back)
+    if (parser.isSet(initial_orders)) {
+        int n = parser.value(initial_orders).toInt();
+        if (n != 1 and n != 2) {
+            fprintf(stderr, "qedsac: initial orders must be 1 or 2\n");
+            return 2;
+        }
+        Settings::set_initial_orders(n);
+    }
+    if (parser.isSet(simulate_loader)) { Settings::set_native_loader(false); }
+    if (parser.isSet(no_cache)) { Settings::set_load_cache(false); }
+    if (parser.isSet(verify) or parser.isSet(verify_random)) {
+        Settings::set_intrinsics(false);    // (only those asked for)
+        Settings::set_jit(false);
+        Settings::set_fusion(false);
+    }
+    if (parser.isSet(intrinsics)) { Settings::set_intrinsics(true); }
+    if (parser.isSet(jit)) { Settings::set_jit(true); }
+    if (parser.isSet(fuse)) { Settings::set_fusion(true); }
+    if (parser.isSet(check_intrinsics)) {
+        edsac->load_program(QString());     // (IO2 has the constant in 3)
+        unsigned n = parser.value(check_intrinsics).toUInt();
+        return edsac->check_intrinsics(n) == 0 ? 0 : 1;
+    }
+    if (parser.isSet(verify_random)) {
+        edsac->load_program(QString());
+        unsigned n = parser.value(verify_random).toUInt();
+        return edsac->verify_random(n) == 0 ? 0 : 1;
+    }
+    if (parser.isSet(microbench)) {
+        unsigned n = parser.value(microbench).toUInt();
+        return Microbench(edsac).run(n);
+    }
+
+    // check the post-mortem requests before running anything
+    struct Dump { Post_Mortem::Format format; ADDR first, last; };
+    std::vector<Dump> dumps;
+    for (const QString& spec : parser.values(post_mortem)) {
+        Dump d;
+        int colon = spec.indexOf(':');
+        bool ok;
+        unsigned n = spec.left(colon).toUInt(&ok);
+        d.format = Post_Mortem::Format(n);
+        if (not ok or n >= Post_Mortem::NUM_FORMATS
+            or not Post_Mortem::parse_range(
+                    colon < 0 ? QString("0") : spec.mid(colon + 1),
+                    d.first, d.last))
+        {
+            fprintf(stderr, "qedsac: bad post-mortem request %s\n",
+                qPrintable(spec));
+            return 2;
+        }
+        dumps.push_back(d);
+    }
+
+    QFile f(args[0]);
+    if (not f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        fprintf(stderr, "qedsac: unable to open %s\n", qPrintable(args[0]));
+        return 2;
+    }
+    QTextStream in(&f);
+    QString tape = in.readAll();
+
+    uint64_t limit = parser.isSet(orders) ? parser.value(orders).toULongLong()
+                                          : ~uint64_t(0);
+    if (parser.isSet(sweep)) {
+        if (parser.isSet(data)) {
+            QFile d(parser.value(data));
+            if (not d.open(QIODevice::ReadOnly | QIODevice::Text)) {
+                fprintf(stderr, "qedsac: unable to open %s\n",
+                    qPrintable(parser.value(data)));
+                return 2;
+            }
+            tape += "\n" + QTextStream(&d).readAll();
+        }
+        Sweep s(edsac, tape);
+        for (const QString& spec : parser.values(sweep)) {
+            if (not s.add_values(spec)) { return 2; }
+        }
+        unsigned n = parser.isSet(threads) ? parser.value(threads).toUInt()
+                                           : QThread::idealThreadCount();
+        return s.run(parser.isSet(zip), limit, n);
+    }
+
+    if (parser.isSet(bench)) {
+        Bench b(edsac, tape);
+        if (parser.isSet(expect)) {
+            QFile e(parser.value(expect));
+            if (not e.open(QIODevice::ReadOnly | QIODevice::Text)) {
+                fprintf(stderr, "qedsac: unable to open %s\n",
+                    qPrintable(parser.value(expect)));
+                return 2;
+            }
+            b.expect(QTextStream(&e).readAll());
+        }
+        return b.run(limit);
+    }
+
+    // echo teleprinter output (carriage returns are dropped)
+    Teleprinter::Shift_Mode shift = Teleprinter::LETTERS;
+    edsac->set_print_hook([&shift](char c) {
+        QChar qc = Teleprinter::translate(c, shift);
+        if (qc == 'n') { fputc('\n', stdout); }
+        else if (not qc.isLower()) { fputs(qPrintable(QString(qc)), stdout); }
+    });
+
+    edsac->load_program(tape, limit);
+    if (parser.isSet(translate)) {
+        return edsac->translate(parser.value(translate), args[0]) ? 0 : 2;
+    }
+    if (parser.isSet(dial_each)) {
+        return run_each(parser.value(dial_each).split(','), limit);
+    }
+    edsac->queue_dial(parser.value(dial));
+
+    // orders are counted from the start of the tape, so those the native
+    // loader or the image cache stood in for are part of the limit
+    uint64_t loaded = edsac->orders_executed();
+    uint64_t left = (limit > loaded) ? limit - loaded : 0;
+    unsigned long differences = 0;
+    if (parser.isSet(verify)) {
+        differences = edsac->verify_tape(left);
+    } else if (parser.isSet(until_address)) {
+        edsac->run_to_address(parser.value(until_address).toUInt());
+    } else if (parser.isSet(until_print)) {
+        edsac->run_to_print();
+    } else if (parser.isSet(until_output)) {
+        edsac->run_to_output(parser.value(until_output));
+    } else if (parser.isSet(orders)) {
+        edsac->run_orders(left);
+    } else {
+        edsac->run_to_stop();
+    }
+    if (not dumps.empty()) {
+        Post_Mortem pm(edsac->store_image());
+        fputc('\n', stdout);
+        for (const Dump& d : dumps) {
+            fputs(qPrintable(pm.dump(d.format, d.first, d.last)), stdout);
+        }
+    }
+    fflush(stdout);
+
+    Edsac::Stop_Reason why = edsac->stop_reason();
+    summarize(stderr, edsac->orders_executed(), why, (*edsac->sc_tank())[0],
+              edsac->time());
+    if (parser.isSet(fuse)) {
+        const Fusion *f = edsac->fused_pairs();
+        fputs("fused pairs:", stderr);
+        for (int p = 0; p < Fusion::NUM_PATTERNS; p++) {
+            Fusion::Pattern pattern = Fusion::Pattern(p);
+            fprintf(stderr, "%s %s %llu", (p == 0) ? "" : ",",
+                Fusion::name(pattern), (unsigned long long)f->count(pattern));
+        }
+        fputc('\n', stderr);
+    }
+    // (a verified run must also stop where a run should, not only agree)
+    return (differences == 0 and succeeded(why)) ? 0 : 1;
+}
@@ -0,0 +1,21 @@
+/*
+ * headless.h -- declarations for Headless namespace
+ *               (running a tape from the command line, without windows)
+ */
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+namespace Headless {
+
+    // true if the command line asks for a headless run
+    bool requested(int argc, char *argv[]);
+
+    // run the tape named on the command line; returns the exit status
+    int run(int argc, char *argv[]);
+
+    // describe why the machine stopped (an Edsac::Stop_Reason)
+    const char *describe(int why);
+
+};
+
+#endif
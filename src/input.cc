@@ -6,6 +6,7 @@
 
 #include "input.h"
 
+#include "codes.h"
 #include "editor.h"
 #include "error.h"
 #include "settings.h"
@@ -19,24 +20,21 @@ bool Tape_Reader::set_up_tape()
         Error::error("Please load a program");
         return false;
     }
-    tape = w->text();
-    curr_pos = tape.begin();
-    curr_line = 1;
+    set_up_tape(w->text());
     return true;
 }
 
-// "perforator" codes
-static const QString LETTERS = "PQWERTYUIOJπS"  "ZK*.FθDΦHNMΔLXGABCV";
-static const QString FIGURES = "0123456789J#\"" "§(*.F@D!+-'&%XG:?()";
-
-// note that FIGURES includes alternate chars for Greek letters, as
-// well as perforator codes in WWG1951 but not in Tutorial Guide Table 2
-// (WWG has single quote for both S and M in figure shift, so we
-// substitute a double quote for S here)
+// "load" the given text as the tape (for runs without an edit window)
+void Tape_Reader::set_up_tape(const QString& text)
+{
+    tape = text;
+    curr_pos = tape.begin();
+    curr_line = 1;
+}
 
 // get next character from current "tape"
-// (ignore whitespace and comments)
-char Tape_Reader::next_char()
+// (ignore whitespace and comments; errors are only reported if asked)
+char Tape_Reader::next_char(bool report)
 {
     // skip whitespace
     // should unmatched ']' be an error? -> yes, for now
@@ -54,6 +52,7 @@ char Tape_Reader::next_char()
         ++curr_pos;
     }
     if (curr_pos == tape.end()) {   // unexpected EOF
+        if (not report) { return ENDFILE; }
         Error::beep();
         Error::error("End of input tape encountered");
         return ENDFILE;
@@ -61,13 +60,9 @@ char Tape_Reader::next_char()
 
     // convert next input character into appropriate perforator code
     QChar ch = *curr_pos++;
-    // check letter codes...
-    int punch = LETTERS.indexOf(ch, 0, Settings::ignore_case()
-                                           ? Qt::CaseInsensitive
-                                           : Qt::CaseSensitive);
-    // then figure codes
-    if (punch < 0) { punch = FIGURES.indexOf(ch); }
-    if (punch < 0) {    // invalid char
+    int code = punch(ch);
+    if (code < 0) {     // invalid char
+        if (not report) { return INVALID; }
         Error::beep();
         Error::error("Illegal character on line number "
                         + QString::number(curr_line) + "\n['"
@@ -77,5 +72,20 @@ char Tape_Reader::next_char()
                         + "]");
         return INVALID;
     }
-    return punch;
+    return code;
+}
+
+// perforator code for character ch (-1 if there is none)
+int Tape_Reader::punch(QChar ch)
+{
+    // check letter codes...
+    int result = Codes::letter_code(ch.unicode());
+    if (result < 0 and Settings::ignore_case()) {
+        // (the letters are upper case, but for lower case pi and theta)
+        result = Codes::letter_code(ch.toUpper().unicode());
+        if (result < 0) { result = Codes::letter_code(ch.toLower().unicode()); }
+    }
+    // then figure codes
+    if (result < 0) { result = Codes::figure_code(ch.unicode()); }
+    return result;
 }
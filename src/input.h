@@ -14,7 +14,20 @@ public:
     static const char INVALID = char(-2);
 
     bool set_up_tape();
-    char next_char();
+    void set_up_tape(const QString& text);
+    char next_char(bool report = true);
+
+    // perforator code for character ch (-1 if there is none)
+    static int punch(QChar ch);
+
+    // text of the mounted tape
+    const QString& text() const { return tape; }
+
+    // current tape position (for rewinding)
+    int position() const { return curr_pos - tape.begin(); }
+    int line() const { return curr_line; }
+    void set_position(int pos, int line)
+        { curr_pos = tape.begin() + pos; curr_line = line; }
 private:
     QString tape;
     QString::iterator curr_pos;
@@ -0,0 +1,599 @@
+/*
+ * intrinsics.cc -- definitions for Intrinsics class
+ *                  (library subroutines run as host code)
+ */
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+#include "intrinsics.h"
+
+#include "arith.h"
+#include "attributes.h"
+#include "cache.h"
+#include "codes.h"
+#include "edsac.h"
+#include "fusion.h"
+#include "jit.h"
+#include "journal.h"
+#include "settings.h"
+#include "tank.h"
+
+using Codes::code_of;       // punch code for given letter
+
+static const char A = code_of('A'), G = code_of('G');
+static const bool LONG = true;
+
+// the first order of every routine (A 3 F, which starts forming the link)
+static const WORD ENTRY =
+    (WORD(A) << (ADDR_BITS + FLAG_BITS)) + (3 << FLAG_BITS);
+
+// most times a call may go round any one loop before it is left to the
+// simulator (so inputs a routine never finishes with cannot hang the host)
+static const uint64_t MAX_PASSES = 10000;
+
+Intrinsics::Intrinsics(Edsac *e)
+    : edsac(e), decoded(STORE_WORDS, UNKNOWN), covered(STORE_WORDS, false)
+{
+    routines = {
+        { "D6", "A3FT34@S4DE13@T4DSDTDE2@T4DAD"
+                "LDTDA4DLDE8@RDU4DLDA35@T6D"
+                "E25@U8DN8DA6DT6DH6DS6DN4DA4DYF"
+                "G21@SDVDTDEFW1526D", &Intrinsics::d6, 0 },
+        { "E2", "A3FT18@YFLDT6DH4DV4DTDH6DVD"
+                "RDA4DYFT4DA6DLDE4@TDEF", &Intrinsics::e2, 0 },
+        { "S2", "A3FT20@A4DS9@A6@UDHDR1FS21@TD"
+                "N4DRDA4DYFT4DVDTDVDYFG5@EFSF", &Intrinsics::s2, 0 },
+        { "S3", "A3FT20@TDS24@T4DHDVDYFT8DV8DS6D"
+                "E21@T8DS4DADTDA4DRDYFG4@"
+                "EFT8DA4DG14@IF", &Intrinsics::s3, 0 },
+        // (after the orders that read its six coefficients, which
+        // follow it as long numbers)
+        { "T1", "A3FT30@H4DV4DYFT4DH4DN32#@A34#@TD"
+                "NDA36#@TDNDA38#@TDNDA40#@TDND"
+                "A42#@TDNDYFTDNDS4DA31@YFT4DEFIF", &Intrinsics::t1, 12 }
+    };
+
+    // assemble each routine as IO2 would (relative to theta = 0)
+    for (Routine& r : routines) {
+        TICKS t = 0;
+        for (const char *p = r.text; *p != '\0'; ) {
+            char func = code_of(*p++);
+            WORD w = WORD(func) << (ADDR_BITS + FLAG_BITS);
+            unsigned n = 0;
+            while (*p >= '0' and *p <= '9') { n = 10*n + (*p++ - '0'); }
+            char term = *p++;
+            bool relative = (term == '@');
+            if (term == '#') { ++p; relative = true; }  // (#@: long, too)
+            w += (n << FLAG_BITS) + (term == 'D' or term == '#');
+            r.image.push_back(w);
+            r.relative.push_back(relative);
+            r.elapsed.push_back(t);
+            t += Edsac::timings[int(func)];
+        }
+        r.elapsed.push_back(t);
+        // the link is planted by the second order (T link @)
+        r.link = (r.image[1] >> FLAG_BITS) & MAX_ADDR;
+        max_size = std::max(max_size, unsigned(r.image.size()));
+    }
+}
+
+// forget every routine (the store has been changed wholesale)
+void Intrinsics::flush()
+{
+    std::fill(decoded.begin(), decoded.end(), UNKNOWN);
+    std::fill(covered.begin(), covered.end(), false);
+}
+
+// run the call to the routine starting at (at), if there is one (true if
+// so), leaving everything as interpreting it would
+// (not while the load cache must see every order)
+bool Intrinsics::call(ADDR at)
+{
+    if (edsac->cache->is_watching()) { return false; }
+    uint8_t i = decoded[at % STORE_WORDS];
+    if (i == UNKNOWN) { i = decode(at); }
+    if (i == NONE) { return false; }
+
+    // run it on copies of the registers and working locations
+    routine = &routines[i];
+    theta = at;
+    std::copy(edsac->acc.begin(), edsac->acc.end(), acc);
+    std::copy(edsac->mcand.begin(), edsac->mcand.end(), mcand);
+    std::copy(edsac->mplier.begin(), edsac->mplier.end(), mplier);
+    for (ADDR a = 0; a < NUM_WORKING; a++) {
+        working[a] = word_at(&edsac->store[tank_num(a)], a & OFFSET_MASK);
+    }
+    written = 0;
+    orders = 0;
+    ticks = 0;
+    if (not (this->*routine->body)()
+        or not edsac->within_bounds(at, orders + 1, routine->image.size()))
+    {
+        return false;       // (the link is one more order)
+    }
+
+    // then put back what it left (the whole call is one step for the
+    // journal, and ends its segment: replays interpret it order by order)
+    bool journaling = Settings::journal_depth() != 0;
+    if (journaling) { edsac->journal->begin_order(); }
+    edsac->halted = false;
+    std::copy(acc, acc + 4, edsac->acc.begin());
+    std::copy(mcand, mcand + 2, edsac->mcand.begin());
+    std::copy(mplier, mplier + 2, edsac->mplier.begin());
+    for (ADDR a = 0; a < NUM_WORKING; a++) {
+        if ((written & (1u << a)) != 0) {
+            edsac->store_word(a, working[a]);
+            edsac->update_tube(STORE, a);
+        }
+    }
+    ADDR link_at = (theta + routine->link) & MAX_ADDR;
+    edsac->store_word(link_at, link_word);
+    edsac->update_tube(ACC);
+    edsac->update_tube(MCAND);
+    edsac->update_tube(MPLIER);
+
+    // and run the link, which returns from the routine
+    edsac->order[0] = link_word;
+    edsac->sct[0] = (link_at + 1) & MAX_ADDR;
+    char func = link_word >> (ADDR_BITS + FLAG_BITS);
+    edsac->obey(func, (link_word >> FLAG_BITS) & MAX_ADDR,
+                (link_word & MAX_FLAG) != 0);
+    ++orders;
+    ticks += Edsac::timings[int(func)];
+    edsac->order_count += orders;
+    if (edsac->running and edsac->sct[0] <= link_at) {
+        edsac->check_loop(link_at, func);
+    }
+    edsac->update_tube(SCT);
+    edsac->update_tube(ORDER);
+    edsac->advance_clock(ticks);
+    if (journaling) { edsac->journal->end_order(); }
+    edsac->journal->close_segment();
+    edsac->pace(ticks);
+    return true;
+}
+
+// the routine starting at (at), or NONE (kept as well: a write to any
+// word a routine would have compared makes the entry look again)
+uint8_t Intrinsics::decode(ADDR at)
+{
+    uint8_t& d = decoded[at % STORE_WORDS];
+    if (word_at(&edsac->store[tank_num(at)], at & OFFSET_MASK) != ENTRY) {
+        return d = NONE;
+    }
+    for (unsigned i = 0; i < routines.size(); i++) {
+        const Routine& r = routines[i];
+        if (matches(r, at)) {
+            cover(r, at);
+            return d = i;
+        }
+    }
+    for (const Routine& r : routines) { cover(r, at); }
+    return d = NONE;
+}
+
+// true if routine r is in the store, starting at location (at)
+// (apart from its link, which every call plants anew)
+bool Intrinsics::matches(const Routine& r, ADDR at) const
+{
+    if (at < NUM_WORKING or at + r.image.size() + r.data > MAX_ADDR + 1) {
+        return false;       // (it would overwrite itself)
+    }
+    for (unsigned k = 0; k < r.image.size(); k++) {
+        if (k == r.link) { continue; }
+        WORD w = r.image[k];
+        if (r.relative[k]) { w = (w + (WORD(at) << FLAG_BITS)) & MAX_HIWORD; }
+        if (word_at(&edsac->store[tank_num(at + k)], (at + k) & OFFSET_MASK)
+            != w)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// watch the words routine r compares when it starts at (at)
+// (not its link, which every call plants anew)
+void Intrinsics::cover(const Routine& r, ADDR at)
+{
+    for (unsigned k = 0; k < r.image.size(); k++) {
+        if (k != r.link) { covered[(at + k) % STORE_WORDS] = true; }
+    }
+}
+
+// forget the routines that include store location a
+void Intrinsics::forget(ADDR a)
+{
+    for (unsigned k = 0; k < max_size; k++) {
+        decoded[(a + STORE_WORDS - k) % STORE_WORDS] = UNKNOWN;
+    }
+}
+
+// D6 -- division
+bool Intrinsics::d6()
+{
+    add(3);                         // 0-1: plant link
+    transfer(theta + 34);
+    uint64_t n1 = 0, n2 = 0, n3 = 0;
+    for (;;) {                      // 2-7
+        subtract(4, LONG);
+        if (not negative()) { break; }  // E 13 @
+        transfer(4, LONG);
+        subtract(0, LONG);
+        transfer(0, LONG);          // E 2 @ (always taken)
+        if (++n1 > MAX_PASSES) { return false; }
+    }
+    for (;;) {                      // 13-14, 8-12
+        lshift(1);
+        if (negative()) { break; }  // E 8 @
+        transfer(4, LONG);
+        add(0, LONG);
+        lshift(1);
+        transfer(0, LONG);
+        add(4, LONG);
+        if (++n2 > MAX_PASSES) { return false; }
+    }
+    rshift(1);                      // 15-20
+    u_transfer(4, LONG);
+    lshift(1);
+    add(theta + 35);
+    transfer(6, LONG);              // E 25 @ (always taken)
+    for (;;) {                      // 25-30, 21-24
+        load_multiplier(6, LONG);
+        subtract(6, LONG);
+        mult_subtract(4, LONG);
+        add(4, LONG);
+        roundoff();
+        if (not negative()) { break; }  // G 21 @
+        u_transfer(8, LONG);
+        mult_subtract(8, LONG);
+        add(6, LONG);
+        transfer(6, LONG);
+        if (++n3 > MAX_PASSES) { return false; }
+    }
+    subtract(0, LONG);              // 31-33
+    mult_add(0, LONG);
+    transfer(0, LONG);
+
+    count(0, 1);
+    count(2, 7, n1);
+    count(2, 3);
+    count(8, 14, n2);
+    count(13, 14);
+    count(15, 20);
+    count(21, 30, n3);
+    count(25, 33);
+    return true;
+}
+
+// E2 -- exponential
+bool Intrinsics::e2()
+{
+    add(3);                         // 0-1: plant link
+    transfer(theta + 18);
+    roundoff();
+    lshift(1);
+    uint64_t n = 1;
+    for (;; n++) {                  // 4-16
+        transfer(6, LONG);
+        load_multiplier(4, LONG);
+        mult_add(4, LONG);
+        transfer(0, LONG);
+        load_multiplier(6, LONG);
+        mult_add(0, LONG);
+        rshift(1);
+        add(4, LONG);
+        roundoff();
+        transfer(4, LONG);
+        add(6, LONG);
+        lshift(1);
+        if (negative()) { break; }  // E 4 @
+        if (n > MAX_PASSES) { return false; }
+    }
+    transfer(0, LONG);
+
+    count(0, 3);
+    count(4, 16, n);
+    count(17, 17);
+    return true;
+}
+
+// S2 -- square root
+bool Intrinsics::s2()
+{
+    add(3);                         // 0-1: plant link
+    transfer(theta + 20);
+    add(4, LONG);
+    subtract(theta + 9);
+    add(theta + 6);
+    uint64_t n = 1;
+    for (;; n++) {                  // 5-19
+        u_transfer(0, LONG);
+        load_multiplier(0, LONG);
+        rshift(2);
+        subtract(theta + 21);
+        transfer(0, LONG);
+        mult_subtract(4, LONG);
+        rshift(1);
+        add(4, LONG);
+        roundoff();
+        transfer(4, LONG);
+        mult_add(0, LONG);
+        transfer(0, LONG);
+        mult_add(0, LONG);
+        roundoff();
+        if (not negative()) { break; }  // G 5 @
+        if (n > MAX_PASSES) { return false; }
+    }
+
+    count(0, 4);
+    count(5, 19, n);
+    return true;
+}
+
+// S3 -- cube root
+bool Intrinsics::s3()
+{
+    add(3);                         // 0-1: plant link
+    transfer(theta + 20);
+    transfer(0, LONG);
+    subtract(theta + 24);
+    uint64_t above = 0, below = 0;  // # times 21-23, or 12-13, were run
+    for (;;) {                      // 4-19 (and 21-23)
+        transfer(4, LONG);
+        load_multiplier(0, LONG);
+        mult_add(0, LONG);
+        roundoff();
+        transfer(8, LONG);
+        mult_add(8, LONG);
+        subtract(6, LONG);
+        if (not negative()) {       // E 21 @
+            transfer(8, LONG);
+            add(4, LONG);
+            if (not negative()) { return false; }   // G 14 @ (else into
+            ++above;                                 // the constant)
+        } else {
+            transfer(8, LONG);
+            subtract(4, LONG);
+            ++below;
+        }
+        add(0, LONG);               // 14
+        transfer(0, LONG);
+        add(4, LONG);
+        rshift(1);
+        roundoff();
+        if (not negative()) { break; }  // G 4 @
+        if (above + below > MAX_PASSES) { return false; }
+    }
+
+    count(0, 3);
+    count(4, 11, above + below);
+    count(12, 13, below);
+    count(21, 23, above);
+    count(14, 19, above + below);
+    return true;
+}
+
+// T1 -- cosine
+bool Intrinsics::t1()
+{
+    add(3);                         // 0-1: plant link
+    transfer(theta + 30);
+    load_multiplier(4, LONG);       // 2-5: the square of the argument
+    mult_add(4, LONG);
+    roundoff();
+    transfer(4, LONG);
+    load_multiplier(4, LONG);       // 6-22: the series, by Horner's rule
+    mult_subtract(theta + 32, LONG);
+    for (ADDR c = theta + 34; c <= theta + 42; c += 2) {
+        add(c, LONG);
+        transfer(0, LONG);
+        mult_subtract(0, LONG);
+    }
+    roundoff();                     // 23-29
+    transfer(0, LONG);
+    mult_subtract(0, LONG);
+    subtract(4, LONG);
+    add(theta + 31);
+    roundoff();
+    transfer(4, LONG);
+
+    count(0, 29);
+    return true;
+}
+
+// the word in store location (a), as the routine sees it
+WORD Intrinsics::get(ADDR a) const
+{
+    a &= MAX_ADDR;
+    if (a < NUM_WORKING) { return working[a]; }
+    return word_at(&edsac->store[tank_num(a)], a & OFFSET_MASK);
+}
+
+// set value as the contents of store location (a)
+// (a working location, or the link: the routines write nothing else)
+void Intrinsics::put(ADDR a, WORD value)
+{
+    a &= MAX_ADDR;
+    if (a < NUM_WORKING) {
+        working[a] = value;
+        written |= 1u << a;
+    } else {
+        link_word = value;
+    }
+}
+
+// load register reg with the (possibly long) word in location (a)
+void Intrinsics::load(WORD reg[], ADDR a, bool lflag)
+{
+    Edsac::adjust_addr(a, lflag);
+    reg[0] = lflag ? get(a++) : 0;
+    reg[1] = get(a);
+}
+
+// A, S, H, V, N, T, U, R, L, and Y, as the order functions do them
+void Intrinsics::add(ADDR a, bool lflag)
+{
+    load(mcand, a, lflag);
+    add_number(acc, mcand[0], mcand[1]);
+}
+
+void Intrinsics::subtract(ADDR a, bool lflag)
+{
+    load(mcand, a, lflag);
+    subtract_number(acc, mcand[0], mcand[1]);
+}
+
+void Intrinsics::load_multiplier(ADDR a, bool lflag)
+{
+    load(mplier, a, lflag);
+}
+
+void Intrinsics::mult_add(ADDR a, bool lflag)
+{
+    load(mcand, a, lflag);
+    multiply_numbers(acc, long_word(mcand[0], mcand[1]),
+                     long_word(mplier[0], mplier[1]), false);
+    mcand[0] = mcand[1] = 0;
+}
+
+void Intrinsics::mult_subtract(ADDR a, bool lflag)
+{
+    load(mcand, a, lflag);
+    multiply_numbers(acc, long_word(mcand[0], mcand[1]),
+                     long_word(mplier[0], mplier[1]), true);
+    mcand[0] = mcand[1] = 0;
+}
+
+void Intrinsics::transfer(ADDR a, bool lflag)
+{
+    u_transfer(a, lflag);
+    std::fill(acc, acc + 4, 0);
+}
+
+void Intrinsics::u_transfer(ADDR a, bool lflag)
+{
+    Edsac::adjust_addr(a, lflag);
+    if (lflag) { put(a++, acc[2]); }
+    put(a, acc[3]);
+}
+
+void Intrinsics::rshift(int n)
+{
+    for (int i = 0; i < n; i++) { shift_right(acc, 4); }
+}
+
+void Intrinsics::lshift(int n)
+{
+    for (int i = 0; i < n; i++) { shift_left(acc, 4); }
+}
+
+void Intrinsics::roundoff()
+{
+    round_off(acc);
+}
+
+// true if the accumulator is negative (E does not branch, G does)
+bool Intrinsics::negative() const
+{
+    return (acc[3] & SIGN_BIT) != 0;
+}
+
+// count words first to last of the routine as run (times times)
+void Intrinsics::count(unsigned first, unsigned last, uint64_t times)
+{
+    orders += (last - first + 1) * times;
+    ticks += (routine->elapsed[last + 1] - routine->elapsed[first]) * times;
+}
+
+// compare each routine run as host code with interpreting it, over
+// n random inputs (prints a line per routine; returns # mismatches)
+unsigned long Intrinsics::check(unsigned n)
+{
+    static const ADDR THETA = 56;       // where each routine is put
+    static const ADDR CALL = 200;       // ... and the call to it
+    static const unsigned long MAX_RUN = 20000;
+
+    auto set = [this](ADDR a, WORD value) {
+        store_word_at(&edsac->store[tank_num(a)], a & OFFSET_MASK, value);
+        edsac->jit->note_write(a);
+        edsac->fusion->note_write(a);
+        note_write(a);
+    };
+    Tank *tanks[] = { &edsac->acc, &edsac->mcand, &edsac->mplier,
+                      &edsac->sct, &edsac->order };
+    auto save = [this, &tanks](std::vector<TICKS>& v) {
+        v.clear();
+        for (Tank *t : tanks) { v.insert(v.end(), t->begin(), t->end()); }
+        for (Tank& t : edsac->store) { v.insert(v.end(), t.begin(), t.end()); }
+        v.push_back(edsac->sim_time);
+        v.push_back(edsac->order_count);
+    };
+    auto restore = [this, &tanks](const std::vector<TICKS>& v) {
+        auto p = v.begin();
+        for (Tank *t : tanks) {
+            for (WORD *q = t->begin(); q != t->end(); q++) { *q = *p++; }
+        }
+        for (Tank& t : edsac->store) {
+            for (WORD *q = t.begin(); q != t.end(); q++) { *q = *p++; }
+        }
+        edsac->sim_time = *p++;
+        edsac->order_count = *p++;
+    };
+
+    std::mt19937 rng(1949);
+    bool was_on = Settings::intrinsics();
+    unsigned long total = 0;
+    for (const Routine& r : routines) {
+        unsigned long mismatches = 0, unfinished = 0;
+        for (unsigned trial = 0; trial < n; trial++) {
+            // the routine (with random numbers after it, if it reads
+            // any), a call to it (A CALL F, G THETA F, Z F), and random
+            // registers and working locations
+            for (unsigned k = 0; k < r.image.size(); k++) {
+                WORD w = r.image[k];
+                if (r.relative[k]) { w += WORD(THETA) << FLAG_BITS; }
+                set(THETA + k, w & MAX_HIWORD);
+            }
+            for (unsigned k = 0; k < r.data; k++) {
+                set(THETA + r.image.size() + k, rng() & MAX_HIWORD);
+            }
+            const unsigned FUNC_SHIFT = ADDR_BITS + FLAG_BITS;
+            set(CALL, (WORD(A) << FUNC_SHIFT) + (CALL << FLAG_BITS));
+            set(CALL + 1, (WORD(G) << FUNC_SHIFT) + (THETA << FLAG_BITS));
+            set(CALL + 2, WORD(code_of('Z')) << FUNC_SHIFT);
+            for (Tank *t : { &edsac->acc, &edsac->mcand, &edsac->mplier }) {
+                for (WORD *q = t->begin(); q != t->end(); q++) {
+                    *q = rng() & (q + 1 == t->end() ? MAX_HIWORD
+                                                    : MAX_LOWORD);
+                }
+            }
+            for (ADDR a = 0; a < NUM_WORKING; a++) {
+                if (a != 2 and a != 3) { set(a, rng() & MAX_HIWORD); }
+            }
+            edsac->acc[3] = 0;      // (as the call expects)
+            edsac->sct[0] = CALL;
+
+            // run it both ways from the same state
+            std::vector<TICKS> before, after[2];
+            save(before);
+            for (int native = 0; native < 2; native++) {
+                restore(before);
+                Settings::set_intrinsics(native);
+                unsigned long count = 0;
+                edsac->run_until([this, &count]() {
+                    return edsac->sct[0] == CALL + 2 or ++count >= MAX_RUN;
+                });
+                save(after[native]);
+            }
+            if (edsac->sct[0] != CALL + 2) { ++unfinished; }
+            else if (after[0] != after[1]) { ++mismatches; }
+        }
+        printf("%s: %u trials, %lu mismatches (%lu not finished)\n",
+               r.name, n, mismatches, unfinished);
+        total += mismatches;
+    }
+    Settings::set_intrinsics(was_on);
+    return total;
+}
@@ -0,0 +1,116 @@
+/*
+ * intrinsics.h -- declarations for Intrinsics class
+ *                 (library subroutines run as host code)
+ */
+#ifndef INTRINSICS_H
+#define INTRINSICS_H
+
+#include <vector>
+
+#include "attributes.h"
+
+class Edsac;
+
+// Recognises standard library routines (D6, E2, S2, S3, T1) in the store
+// by their contents, and runs each call through to its return as host
+// code.  The routine's orders are done by host arithmetic on copies of
+// the registers and working locations (the same arithmetic the order
+// functions use, so the results are exactly the simulated ones), and
+// only the final state is put back: registers, the working locations
+// and link written, and the order count and time, worked out from how
+// often each loop went round.  The routine found at each store location
+// is kept until one of its words is written, as the fusion's pairs are.
+// A call that would run into a routine's constants, or go round a loop
+// too often, is left to the simulator.  (R9, which reads numbers from
+// the tape while orders are being input, is not a routine of this kind.)
+class Intrinsics
+{
+public:
+    Intrinsics(Edsac *e);
+
+    // if the order at (at) -- where sequence control is -- starts a known
+    // routine, run the call to its return (true if so)
+    bool run(ADDR at)
+        { return decoded[at % STORE_WORDS] != NONE and call(at); }
+
+    // forget the routine that includes store location a (it has been
+    // written), or every routine (the store has been changed wholesale)
+    void note_write(ADDR a)
+    {   decoded[a % STORE_WORDS] = UNKNOWN;
+        if (covered[a % STORE_WORDS]) { forget(a); }
+    }
+    void flush();
+
+    // compare each routine run as host code with interpreting it, over
+    // n random inputs (prints a line per routine; returns # mismatches)
+    unsigned long check(unsigned n);
+private:
+    static const uint8_t UNKNOWN = 255, NONE = 254;
+
+    // the routines' working locations are 0-9 (0, 4, 6, 8 as long words;
+    // 3 holds the constant U 2 F that forms the link)
+    static const ADDR NUM_WORKING = 10;
+
+    typedef bool (Intrinsics::*BODY)();
+    struct Routine {
+        const char *name;
+        const char *text;           // as punched, after GK
+        BODY body;
+        unsigned data;              // # words after it read as numbers
+        std::vector<WORD> image;    // assembled for theta = 0
+        std::vector<bool> relative; // ... and which words are relocated
+        std::vector<TICKS> elapsed; // time to run the words before each
+        ADDR link;                  // where the return link is planted
+    };
+
+    bool call(ADDR at);
+    uint8_t decode(ADDR at);
+    bool matches(const Routine& r, ADDR at) const;
+    void cover(const Routine& r, ADDR at);
+    void forget(ADDR a);
+
+    // the routines (theta is where the routine starts); false if the
+    // call is to be left to the simulator
+    bool d6();
+    bool e2();
+    bool s2();
+    bool s3();
+    bool t1();
+
+    // the order functions, on the copies of the registers
+    WORD get(ADDR a) const;
+    void put(ADDR a, WORD value);
+    void load(WORD reg[], ADDR a, bool lflag);
+    void add(ADDR a, bool lflag = false);
+    void subtract(ADDR a, bool lflag = false);
+    void load_multiplier(ADDR a, bool lflag);
+    void mult_add(ADDR a, bool lflag);
+    void mult_subtract(ADDR a, bool lflag);
+    void transfer(ADDR a, bool lflag = false);
+    void u_transfer(ADDR a, bool lflag);
+    void rshift(int n);
+    void lshift(int n);
+    void roundoff();
+    bool negative() const;
+
+    // count words first to last of the routine as run (times times)
+    void count(unsigned first, unsigned last, uint64_t times = 1);
+
+    Edsac *edsac;
+    std::vector<Routine> routines;
+    unsigned max_size = 0;          // # words in the longest routine
+    std::vector<uint8_t> decoded;   // routine starting at each location
+    std::vector<bool> covered;      // ... and the words that hold them
+
+    // the call being run
+    const Routine *routine = nullptr;
+    ADDR theta = 0;
+    WORD acc[4], mcand[2], mplier[2];
+    WORD working[NUM_WORKING];      // the working locations
+    unsigned written = 0;           // ... those written (a bit each)
+    WORD link_word = 0;             // the link planted
+    uint64_t orders = 0;            // # orders run by the routine
+    TICKS ticks = 0;                // ... and the time they took
+};
+
+#endif
@@ -0,0 +1,385 @@
+/*
+ * jit.cc -- definitions for Jit class
+ *           (runs of orders translated to native x86-64 code)
+ */
+#include <cstddef>
+#include <cstring>
+
+#include "jit.h"
+
+#ifdef JIT_NATIVE
+#include <sys/mman.h>
+#endif
+
+#include "attributes.h"
+#include "cache.h"
+#include "codes.h"
+#include "edsac.h"
+#include "fusion.h"
+#include "intrinsics.h"
+#include "settings.h"
+#include "tank.h"
+
+using Codes::code_of;       // punch code for given letter
+
+// size of the executable buffer (every run is dropped when it fills)
+static const size_t BUFFER_SIZE = 4 << 20;
+
+// host registers (x86-64 numbering), and what the translated code keeps
+// in them: r8 = acc[3]:acc[2], r9 = acc[1]:acc[0], r10 and r11 = masks;
+// rax, rcx, rdx, and rsi are scratch, and rdi points at the Native_State
+enum { RAX = 0, RCX = 1, RDX = 2, RSI = 6, RDI = 7,
+       R8 = 8, R9 = 9, R10 = 10, R11 = 11 };
+static const int ACC_HIGH = R8, ACC_LOW = R9, MASK_HIGH = R10, MASK_LOW = R11;
+
+// opcodes (reg/mem, reg forms) and shift extensions used
+enum { ADD = 0x01, OR = 0x09, AND = 0x21, SUB = 0x29, XOR = 0x31,
+       MOV = 0x89, MOV_LOAD = 0x8b };
+enum { SHL = 4, SHR = 5, SAR = 7 };
+
+static const LONGWORD MASK_36 = (LONGWORD(1) << (2 * LOWORD_BITS)) - 1;
+
+Jit::Jit(Edsac *e)
+    : edsac(e), runs(MAX_ADDR + 1), covered(STORE_WORDS),
+      rewrites(STORE_WORDS)
+{
+#ifdef JIT_NATIVE
+    void *p = mmap(nullptr, BUFFER_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p != MAP_FAILED) {          // (else everything is interpreted)
+        buffer = static_cast<uint8_t *>(p);
+        buffer_size = BUFFER_SIZE;
+    }
+#endif
+}
+
+Jit::~Jit()
+{
+#ifdef JIT_NATIVE
+    if (buffer != nullptr) { munmap(buffer, buffer_size); }
+#endif
+}
+
+// if sequence control is at a run of orders that can be translated, run
+// it as native code (true if so)
+// (not while the journal or the load cache must see every order)
+bool Jit::run()
+{
+    if (buffer == nullptr or Settings::journal_depth() != 0
+        or edsac->cache->is_watching())
+    {
+        return false;
+    }
+    ADDR at = edsac->sct[0];
+    Run& r = runs[at];
+    if (not r.tried) { translate(at); }
+    if (r.code == nullptr or not edsac->within_bounds(at, r.length, r.length))
+    {
+        return false;
+    }
+
+    Native_State s;
+    Tank& acc = edsac->acc;
+    s.acc_high = (LONGWORD(acc[3]) << LOWORD_BITS) | acc[2];
+    s.acc_low = (LONGWORD(acc[1]) << LOWORD_BITS) | acc[0];
+    s.mcand[0] = edsac->mcand[0]; s.mcand[1] = edsac->mcand[1];
+    s.mplier[0] = edsac->mplier[0]; s.mplier[1] = edsac->mplier[1];
+    r.code(&s);
+    acc[0] = s.acc_low & MAX_LOWORD;
+    acc[1] = s.acc_low >> LOWORD_BITS;
+    acc[2] = s.acc_high & MAX_LOWORD;
+    acc[3] = s.acc_high >> LOWORD_BITS;
+    edsac->mcand[0] = s.mcand[0]; edsac->mcand[1] = s.mcand[1];
+    edsac->mplier[0] = s.mplier[0]; edsac->mplier[1] = s.mplier[1];
+
+    edsac->halted = false;
+    edsac->sct[0] = (at + r.length) & MAX_ADDR;
+    edsac->order[0] = r.last_order;
+    for (ADDR a : r.writes) {       // (this may drop r itself)
+        note_write(a);
+        edsac->fusion->note_write(a);
+        edsac->intrinsics->note_write(a);
+        edsac->update_tube(STORE, a);
+    }
+    edsac->update_tube(SCT);
+    edsac->update_tube(ORDER);
+    edsac->update_tube(ACC);
+    edsac->update_tube(MCAND);
+    edsac->update_tube(MPLIER);
+    edsac->order_count += r.length;
+    edsac->advance_clock(r.ticks);
+    edsac->pace(r.ticks);
+    return true;
+}
+
+// forget every run (the store has been changed wholesale)
+void Jit::flush()
+{
+    for (Run& r : runs) { r = Run(); }
+    std::fill(covered.begin(), covered.end(), 0);
+    std::fill(rewrites.begin(), rewrites.end(), 0);
+    used = 0;
+}
+
+// translate the run of orders starting at (at)
+// (false, with the run marked as tried, if its first order can't be)
+bool Jit::translate(ADDR at)
+{
+    static const char A = code_of('A'), S = code_of('S'), H = code_of('H'),
+                      C = code_of('C'), T = code_of('T'), U = code_of('U'),
+                      R = code_of('R'), L = code_of('L'), Y = code_of('Y'),
+                      X = code_of('X');
+
+    Run& r = runs[at];
+    r.tried = true;
+    r.code = nullptr;
+    r.length = 0;
+    r.ticks = 0;
+    r.writes.clear();
+    if (rewrites[at % STORE_WORDS] >= MAX_REWRITES) {
+        return false;   // (and never looked at again until a flush)
+    }
+    assembled.clear();
+
+    // fetch the registers
+    load_state(ACC_HIGH, offsetof(Native_State, acc_high), true);
+    load_state(ACC_LOW, offsetof(Native_State, acc_low), true);
+    load_imm(MASK_HIGH, MAX_LONGWORD);
+    load_imm(MASK_LOW, MASK_36);
+
+    const int MCAND = offsetof(Native_State, mcand);
+    const int MPLIER = offsetof(Native_State, mplier);
+    unsigned n;
+    for (n = 0; n < MAX_RUN; n++) {
+        ADDR pc = (at + n) & MAX_ADDR;
+        bool overwritten = false;       // (by an earlier order in the run)
+        for (ADDR w : r.writes) {
+            overwritten |= (w % STORE_WORDS == pc % STORE_WORDS);
+        }
+        if (overwritten or rewrites[pc % STORE_WORDS] >= MAX_REWRITES) {
+            break;
+        }
+
+        WORD w = *word_ptr(pc);
+        bool lflag = (w & MAX_FLAG) != 0;
+        ADDR a = (w >> FLAG_BITS) & MAX_ADDR;
+        char func = (w >> (ADDR_BITS + FLAG_BITS)) & MAX_FUNC;
+        if (func == A or func == S or func == C) {
+            load_number(a, lflag, MCAND);
+            if (func == C) {            // (mplier & mcand, packed alike)
+                load_state(RCX, MPLIER + 4, false);
+                shift(SHL, RCX, LOWORD_BITS);
+                load_state(RDX, MPLIER, false);
+                reg_reg(ADD, RCX, RDX);
+                reg_reg(AND, RAX, RCX);
+            }
+            reg_reg(func == S ? SUB : ADD, ACC_HIGH, RAX);
+            reg_reg(AND, ACC_HIGH, MASK_HIGH);
+        } else if (func == H) {
+            load_number(a, lflag, MPLIER);
+        } else if (func == T or func == U) {
+            a &= ~ADDR(lflag);
+            if (lflag) {                // acc[2]
+                reg_reg(MOV, RAX, ACC_HIGH);
+                put({ 0x25 }); put32(MAX_LOWORD);     // and eax, imm32
+                store_word(a, RAX);
+                r.writes.push_back(a++);
+            }
+            reg_reg(MOV, RAX, ACC_HIGH);    // acc[3]
+            shift(SHR, RAX, LOWORD_BITS);
+            store_word(a, RAX);
+            r.writes.push_back(a);
+            if (func == T) {
+                reg_reg(XOR, ACC_HIGH, ACC_HIGH);
+                reg_reg(XOR, ACC_LOW, ACC_LOW);
+            }
+        } else if (func == R or func == L) {
+            // as many places as the position of the order's lowest 1 bit
+            unsigned places = 1;
+            for (WORD c = w & MAX_HIWORD; (c & 1) == 0; c >>= 1) {
+                ++places;
+            }
+            if (func == L) {
+                reg_reg(MOV, RAX, ACC_LOW);
+                shift(SHR, RAX, 2 * LOWORD_BITS - places);
+                shift(SHL, ACC_HIGH, places);
+                reg_reg(OR, ACC_HIGH, RAX);
+                reg_reg(AND, ACC_HIGH, MASK_HIGH);
+                shift(SHL, ACC_LOW, places);
+                reg_reg(AND, ACC_LOW, MASK_LOW);
+            } else {                    // (arithmetic)
+                reg_reg(MOV, RAX, ACC_HIGH);
+                shift(SHL, RAX, 2 * LOWORD_BITS - places);
+                shift(SHR, ACC_LOW, places);
+                reg_reg(OR, ACC_LOW, RAX);
+                reg_reg(AND, ACC_LOW, MASK_LOW);
+                shift(SHL, ACC_HIGH, 64 - LONGWORD_BITS);
+                shift(SAR, ACC_HIGH, 64 - LONGWORD_BITS + places);
+                reg_reg(AND, ACC_HIGH, MASK_HIGH);
+            }
+        } else if (func == Y) {         // add 2^-35 (carrying up)
+            load_imm(RAX, LONGWORD(SANDWICH_BIT) << LOWORD_BITS);
+            reg_reg(ADD, ACC_LOW, RAX);
+            reg_reg(MOV, RAX, ACC_LOW);
+            shift(SHR, RAX, 2 * LOWORD_BITS);
+            reg_reg(ADD, ACC_HIGH, RAX);
+            reg_reg(AND, ACC_HIGH, MASK_HIGH);
+            reg_reg(AND, ACC_LOW, MASK_LOW);
+        } else if (func != X) {
+            break;                      // (left to the interpreter)
+        }
+        r.ticks += Edsac::timings[int(func)];
+        r.last_order = w;
+    }
+    if (n == 0) {                       // (nothing to translate)
+        r.writes.clear();
+        r.length = 1;
+        cover(at, 1, 1);
+        return false;
+    }
+
+    // put the registers back
+    store_state(offsetof(Native_State, acc_high), ACC_HIGH, true);
+    store_state(offsetof(Native_State, acc_low), ACC_LOW, true);
+    put({ 0xc3 });                     // ret
+
+    // (in the space the run had before, if the code still fits)
+    if (assembled.size() > r.room) {
+        if (buffer_size - used < assembled.size()) {
+            flush();
+            return translate(at);
+        }
+        r.slot = used;
+        r.room = assembled.size();
+        used += r.room;
+    }
+    memcpy(buffer + r.slot, assembled.data(), assembled.size());
+    r.code = reinterpret_cast<Code>(buffer + r.slot);
+    r.length = n;
+    cover(at, n, 1);
+    return true;
+}
+
+// count (delta = 1) or stop counting (-1) a run covering length words
+void Jit::cover(ADDR start, unsigned length, int delta)
+{
+    for (unsigned k = 0; k < length; k++) {
+        covered[(start + k) % STORE_WORDS] += delta;
+    }
+}
+
+// forget the runs covering store location (index)
+void Jit::invalidate(unsigned index)
+{
+    for (unsigned d = 0; d < MAX_RUN; d++) {
+        unsigned start = (index + STORE_WORDS - d) % STORE_WORDS;
+        for (unsigned s = start; s <= MAX_ADDR; s += STORE_WORDS) {
+            Run& r = runs[s];
+            if (r.tried and d < r.length) {
+                cover(s, r.length, -1);
+                r.tried = false;
+                r.code = nullptr;
+            }
+        }
+    }
+    if (rewrites[index] < MAX_REWRITES) { ++rewrites[index]; }
+}
+
+// where the word at store location (a) is kept
+WORD *Jit::word_ptr(ADDR a) const
+{
+    return edsac->store[tank_num(a)].begin(a & OFFSET_MASK);
+}
+
+//---------- x86-64 instruction encoding ----------
+// bytes, as given
+void Jit::put(std::initializer_list<uint8_t> bytes)
+{
+    assembled.insert(assembled.end(), bytes);
+}
+
+// 32- or 64-bit immediate value (little-endian)
+void Jit::put32(uint32_t x)
+{
+    for (int i = 0; i < 4; i++) { assembled.push_back(x >> (8 * i)); }
+}
+
+void Jit::put64(uint64_t x)
+{
+    for (int i = 0; i < 8; i++) { assembled.push_back(x >> (8 * i)); }
+}
+
+// opcode dst, src (64-bit registers; dst is the r/m operand)
+void Jit::reg_reg(uint8_t opcode, int dst, int src)
+{
+    put({ uint8_t(0x48 | (src >= 8) << 2 | (dst >= 8)), opcode,
+           uint8_t(0xc0 | (src & 7) << 3 | (dst & 7)) });
+}
+
+// shift reg (64-bit) by n places
+void Jit::shift(int ext, int reg, unsigned n)
+{
+    put({ uint8_t(0x48 | (reg >= 8)), 0xc1,
+           uint8_t(0xc0 | ext << 3 | (reg & 7)), uint8_t(n) });
+}
+
+// mov reg, x (64-bit)
+void Jit::load_imm(int reg, uint64_t x)
+{
+    put({ uint8_t(0x48 | (reg >= 8)), uint8_t(0xb8 | (reg & 7)) });
+    put64(x);
+}
+
+// reg (32-bit, zero-extended) = store location (a)
+void Jit::load_word(int reg, ADDR a)
+{
+    load_imm(RSI, reinterpret_cast<uintptr_t>(word_ptr(a)));
+    if (reg >= 8) { put({ 0x44 }); }
+    put({ MOV_LOAD, uint8_t((reg & 7) << 3 | RSI) });
+}
+
+// store location (a) = reg (32-bit)
+void Jit::store_word(ADDR a, int reg)
+{
+    load_imm(RSI, reinterpret_cast<uintptr_t>(word_ptr(a)));
+    if (reg >= 8) { put({ 0x44 }); }
+    put({ MOV, uint8_t((reg & 7) << 3 | RSI) });
+}
+
+// reg = field at offset in the Native_State (64- or 32-bit)
+void Jit::load_state(int reg, int offset, bool wide)
+{
+    uint8_t rex = (wide ? 0x48 : 0x40) | (reg >= 8) << 2;
+    if (rex != 0x40) { put({ rex }); }
+    put({ MOV_LOAD, uint8_t(0x40 | (reg & 7) << 3 | RDI), uint8_t(offset) });
+}
+
+// field at offset in the Native_State = reg (64- or 32-bit)
+void Jit::store_state(int offset, int reg, bool wide)
+{
+    uint8_t rex = (wide ? 0x48 : 0x40) | (reg >= 8) << 2;
+    if (rex != 0x40) { put({ rex }); }
+    put({ MOV, uint8_t(0x40 | (reg & 7) << 3 | RDI), uint8_t(offset) });
+}
+
+// load the (possibly long) number at (a) into the register pair at
+// offset in the Native_State, leaving it in rax packed as in acc_high
+// (as load_mcand() and load_multiplier() do)
+void Jit::load_number(ADDR a, bool lflag, int offset)
+{
+    a &= ~ADDR(lflag);
+    if (lflag) {
+        load_word(RAX, a);
+        store_state(offset, RAX, false);
+        load_word(RCX, a + 1);
+        store_state(offset + 4, RCX, false);
+        shift(SHL, RCX, LOWORD_BITS);
+        reg_reg(ADD, RAX, RCX);
+    } else {
+        reg_reg(XOR, RCX, RCX);
+        store_state(offset, RCX, false);
+        load_word(RAX, a);
+        store_state(offset + 4, RAX, false);
+        shift(SHL, RAX, LOWORD_BITS);
+    }
+}
@@ -0,0 +1,100 @@
+/*
+ * jit.h -- declarations for Jit class
+ *          (runs of orders translated to native x86-64 code)
+ */
+#ifndef JIT_H
+#define JIT_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include "attributes.h"
+
+class Edsac;
+
+// native code is only generated for x86-64 with the System V calling
+// convention (anywhere else, every order is interpreted)
+#if defined(__x86_64__) && !defined(_WIN32)
+#define JIT_NATIVE 1
+#endif
+
+// Translates straight-line runs of orders (A, S, H, C, T, U, R, L, Y, X)
+// into x86-64 code, which keeps the accumulator in host registers while
+// the run lasts.  A run ends before any order that branches, multiplies,
+// reads or prints, or stops the machine, and before any location an
+// earlier order in the run writes; the interpreter does those.  Store
+// writes (the simulator's own, and those of translated runs) drop the
+// runs covering the location written, so a program that modifies its
+// own orders is translated afresh -- except that an order rewritten
+// again and again (an address stepped on each time round a loop) is
+// left to the interpreter, and runs end before it.
+class Jit
+{
+public:
+    Jit(Edsac *e);
+    ~Jit();
+
+    // if sequence control is at a run of orders that can be translated,
+    // run it as native code (true if so)
+    bool run();
+
+    // forget the runs covering store location a (it has been written),
+    // or every run (the store has been changed wholesale)
+    void note_write(ADDR a)
+        { if (covered[a % STORE_WORDS] != 0) { invalidate(a % STORE_WORDS); } }
+    void flush();
+private:
+    static const unsigned MAX_RUN = 64;     // most orders in one run
+    static const uint8_t MAX_REWRITES = 4;  // before an order is left alone
+
+    // the registers as translated code sees them
+    struct Native_State {
+        uint64_t acc_high;      // acc[3]:acc[2] (35 bits)
+        uint64_t acc_low;       // acc[1]:acc[0] (36 bits)
+        uint32_t mcand[2];
+        uint32_t mplier[2];
+    };
+    typedef void (*Code)(Native_State *);
+
+    struct Run {
+        bool tried = false;         // translation attempted
+        Code code = nullptr;        // (null if there was nothing to do)
+        unsigned length = 0;        // # orders (store words covered)
+        WORD last_order = 0;        // the order tank afterwards
+        TICKS ticks = 0;            // time the run takes
+        std::vector<ADDR> writes;   // store locations it writes
+        size_t slot = 0, room = 0;  // code space it has in the buffer
+    };
+
+    bool translate(ADDR at);
+    void cover(ADDR start, unsigned length, int delta);
+    void invalidate(unsigned index);
+    WORD *word_ptr(ADDR a) const;
+
+    // instruction encoding
+    void put(std::initializer_list<uint8_t> bytes);
+    void put32(uint32_t x);
+    void put64(uint64_t x);
+    void reg_reg(uint8_t opcode, int dst, int src);
+    void shift(int ext, int reg, unsigned n);
+    void load_imm(int reg, uint64_t x);
+    void load_word(int reg, ADDR a);
+    void store_word(ADDR a, int reg);
+    void load_state(int reg, int offset, bool wide);
+    void store_state(int offset, int reg, bool wide);
+    void load_number(ADDR a, bool lflag, int offset);
+
+    Edsac *edsac;
+    std::vector<Run> runs;              // by starting address
+    std::vector<uint8_t> covered;       // # runs covering each location
+    std::vector<uint8_t> rewrites;      // # times each has been rewritten
+
+    // executable memory for the translated code
+    uint8_t *buffer = nullptr;
+    size_t buffer_size = 0;
+    size_t used = 0;                    // (code is only added at the end)
+    std::vector<uint8_t> assembled;     // run being translated
+};
+
+#endif
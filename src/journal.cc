@@ -0,0 +1,242 @@
+/*
+ * journal.cc -- definitions for Journal class
+ *               (undo journal for stepping the EDSAC backwards)
+ */
+#include "journal.h"
+
+#include "attributes.h"
+#include "edsac.h"
+#include "input.h"
+#include "settings.h"
+#include "tank.h"
+
+// flags in the first word of an undo record
+// (low bits flag changed register words; the write count is above these)
+static const WORD TAPE_CHANGED = WORD(1) << 10;
+static const WORD PRINT_CHANGED = WORD(1) << 11;
+static const WORD LONG_STEP = WORD(1) << 12;    // (not one order)
+static const unsigned WRITE_COUNT_SHIFT = 13;
+
+// (a 64-bit count takes two words of a record, low half first)
+static const unsigned HALF_BITS = 8 * sizeof(WORD);
+
+Journal::Journal(Edsac *e)
+    : edsac(e)
+{
+    WORD **r = regs;
+    for (Tank *t : { &e->acc, &e->mcand, &e->mplier, &e->sct, &e->order }) {
+        for (auto p = t->begin(); p != t->end(); p++) { *r++ = p; }
+    }
+}
+
+// forget everything (nothing can be undone)
+void Journal::clear()
+{
+    segments.clear();
+    total_orders = 0;
+    records.clear();
+    record_start.clear();
+}
+
+// start a new segment at the current machine state
+// (older segments keep only their anchors)
+void Journal::anchor()
+{
+    if (Settings::journal_depth() == 0) { clear(); return; }
+    segments.push_back(Segment());
+    take_snapshot(segments.back().start);
+    segments.back().orders = 0;
+    records.clear();
+    record_start.clear();
+    closing = false;
+    trim();
+}
+
+// remember the state that the next order may change
+void Journal::begin_order()
+{
+    if (segments.empty() or closing
+        or segments.back().orders >= unsigned(Settings::journal_interval()))
+    {
+        anchor();
+    }
+    for (int i = 0; i < NUM_REG_WORDS; i++) { old_regs[i] = *regs[i]; }
+    old_tape_pos = edsac->input->position();
+    old_tape_line = edsac->input->line();
+    old_last_printed = edsac->last_printed;
+    old_sim_time = edsac->sim_time;
+    old_order_count = edsac->order_count;
+    writes.clear();
+    recording = true;
+}
+
+// add an undo record for the order just executed
+void Journal::end_order()
+{
+    recording = false;
+    record_start.push_back(records.size());
+    records.push_back(0);
+    WORD head = 0;
+    for (int i = 0; i < NUM_REG_WORDS; i++) {
+        if (*regs[i] != old_regs[i]) {
+            head |= WORD(1) << i;
+            records.push_back(old_regs[i]);
+        }
+    }
+    head |= WORD(writes.size() / 2) << WRITE_COUNT_SHIFT;
+    records.insert(records.end(), writes.begin(), writes.end());
+    if (edsac->input->position() != old_tape_pos) {
+        head |= TAPE_CHANGED;
+        records.push_back(old_tape_pos);
+        records.push_back(old_tape_line);
+    }
+    if (edsac->last_printed != old_last_printed) {
+        head |= PRINT_CHANGED;
+        records.push_back(old_last_printed);
+    }
+
+    // the time taken (and, if the step was more than one order, such as
+    // a fast-forwarded loop or a whole library routine, the orders run)
+    TICKS ticks = edsac->sim_time - old_sim_time;
+    uint64_t orders = edsac->order_count - old_order_count;
+    if (orders == 1 and ticks == WORD(ticks)) {
+        records.push_back(ticks);
+    } else {
+        head |= LONG_STEP;
+        records.push_back(WORD(ticks));
+        records.push_back(WORD(ticks >> HALF_BITS));
+        records.push_back(WORD(orders));
+        records.push_back(WORD(orders >> HALF_BITS));
+    }
+    records[record_start.back()] = head;
+    ++segments.back().orders;
+    ++total_orders;
+}
+
+// undo the last order executed (false if there is nothing to undo)
+bool Journal::step_back()
+{
+    // an empty segment's anchor is the previous segment's final state
+    while (not segments.empty() and segments.back().orders == 0) {
+        segments.pop_back();
+        records.clear();
+        record_start.clear();
+    }
+    if (segments.empty()) { return false; }
+
+    if (record_start.empty()) {     // records discarded: regenerate
+        Segment& s = segments.back();
+        unsigned long n = s.orders - 1;
+        restore_snapshot(s.start);
+        total_orders -= s.orders;
+        s.orders = 0;
+        replay(n);
+    } else {
+        undo_record();
+    }
+    return true;
+}
+
+// number of orders that can currently be undone
+unsigned long Journal::depth() const
+{
+    return total_orders;
+}
+
+// copy the whole machine state into snap
+void Journal::take_snapshot(Snapshot& snap) const
+{
+    for (int i = 0; i < NUM_REG_WORDS; i++) { snap.regs[i] = *regs[i]; }
+    snap.store.clear();
+    for (unsigned t = 0; t < NUM_LONG_TANKS; t++) {
+        snap.store.insert(snap.store.end(),
+            edsac->store[t].begin(), edsac->store[t].end());
+    }
+    snap.tape_pos = edsac->input->position();
+    snap.tape_line = edsac->input->line();
+    snap.last_printed = edsac->last_printed;
+    snap.sim_time = edsac->sim_time;
+    snap.order_count = edsac->order_count;
+}
+
+// put the machine back into the state saved in snap
+void Journal::restore_snapshot(const Snapshot& snap)
+{
+    for (int i = 0; i < NUM_REG_WORDS; i++) { *regs[i] = snap.regs[i]; }
+    auto p = snap.store.begin();
+    for (unsigned t = 0; t < NUM_LONG_TANKS; t++) {
+        for (auto q = edsac->store[t].begin(); q != edsac->store[t].end(); ) {
+            *q++ = *p++;
+        }
+    }
+    edsac->input->set_position(snap.tape_pos, snap.tape_line);
+    edsac->last_printed = snap.last_printed;
+    edsac->sim_time = snap.sim_time;
+    edsac->order_count = snap.order_count;
+}
+
+// apply (and discard) the newest undo record
+void Journal::undo_record()
+{
+    unsigned start = record_start.back();
+    auto p = records.begin() + start;
+    WORD head = *p++;
+    for (int i = 0; i < NUM_REG_WORDS; i++) {
+        if ((head & (WORD(1) << i)) != 0) { *regs[i] = *p++; }
+    }
+
+    // restore writes newest first, so a twice-written word gets its
+    // original value back
+    unsigned num_writes = head >> WRITE_COUNT_SHIFT;
+    for (int i = num_writes - 1; i >= 0; i--) {
+        ADDR a = p[2*i];
+        store_word_at(&edsac->store[tank_num(a)], a & OFFSET_MASK, p[2*i+1]);
+    }
+    p += 2 * num_writes;
+
+    if ((head & TAPE_CHANGED) != 0) {
+        edsac->input->set_position(p[0], p[1]);
+        p += 2;
+    }
+    if ((head & PRINT_CHANGED) != 0) { edsac->last_printed = *p++; }
+    if ((head & LONG_STEP) != 0) {
+        edsac->sim_time -= p[0] | TICKS(p[1]) << HALF_BITS;
+        edsac->order_count -= p[2] | uint64_t(p[3]) << HALF_BITS;
+        p += 4;
+    } else {
+        edsac->sim_time -= *p++;
+        --edsac->order_count;
+    }
+
+    records.resize(start);
+    record_start.pop_back();
+    --segments.back().orders;
+    --total_orders;
+}
+
+// run n orders (without output) to regenerate the newest segment's records
+void Journal::replay(unsigned long n)
+{
+    bool was_quiet = edsac->quiet;
+    edsac->quiet = edsac->replaying = true;
+    for (unsigned long i = 0; i < n; i++) { edsac->exec_order(); }
+    edsac->replaying = false;
+    edsac->quiet = was_quiet;
+}
+
+// discard the oldest segments once the journal gets too deep, or holds
+// more snapshots than segments of full length would (each segment closed
+// early, after a fast-forwarded loop or a library routine, keeps a whole
+// store too)
+void Journal::trim()
+{
+    unsigned long max_orders = Settings::journal_depth();
+    size_t max_segments = max_orders / Settings::journal_interval() + 1;
+    while (segments.size() > 1
+           and (total_orders - segments.front().orders >= max_orders
+                or segments.size() > max_segments))
+    {
+        total_orders -= segments.front().orders;
+        segments.pop_front();
+    }
+}
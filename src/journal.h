@@ -0,0 +1,91 @@
+/*
+ * journal.h -- declarations for Journal class
+ *              (undo journal for stepping the EDSAC backwards)
+ */
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "attributes.h"
+
+class Edsac;
+
+// The journal is a list of segments, each starting with a full snapshot
+// of the machine (an "anchor").  The newest segment also keeps a compact
+// undo record for each order run since its anchor: the old contents of
+// every store location written, plus any register words, tape position,
+// or last printed character that changed, and how far the order moved
+// the clock and the order count.  Older segments keep only their anchor;
+// stepping back into one restores the anchor and replays its orders
+// (which regenerates the records).  The oldest segments are dropped once
+// the journal holds more orders than its depth, or more anchors than
+// segments of full length would need.
+class Journal
+{
+public:
+    Journal(Edsac *e);
+
+    void clear();
+    void anchor();
+
+    // start a new segment before the next order (after an order that
+    // replaying could not reproduce)
+    void close_segment() { closing = true; }
+
+    // bracket each order executed (with note_write() for store writes)
+    void begin_order();
+    void note_write(ADDR a, WORD old_value)
+        { if (recording) { writes.push_back(a); writes.push_back(old_value); } }
+    void end_order();
+
+    bool step_back();
+
+    // number of orders that can currently be undone
+    unsigned long depth() const;
+private:
+    static const int NUM_REG_WORDS = 10;
+
+    struct Snapshot {
+        WORD regs[NUM_REG_WORDS];
+        std::vector<WORD> store;
+        int tape_pos, tape_line;
+        char last_printed;
+        TICKS sim_time;
+        uint64_t order_count;
+    };
+    struct Segment {
+        Snapshot start;
+        unsigned long orders;       // # of orders run since anchor
+    };
+
+    void take_snapshot(Snapshot& snap) const;
+    void restore_snapshot(const Snapshot& snap);
+    void undo_record();
+    void replay(unsigned long n);
+    void trim();
+
+    Edsac *edsac;
+    WORD *regs[NUM_REG_WORDS];      // every short tank word
+
+    std::deque<Segment> segments;
+    unsigned long total_orders = 0;
+
+    // undo records for newest segment (flattened), and where each starts
+    std::vector<WORD> records;
+    std::vector<unsigned> record_start;
+
+    // state captured by begin_order()
+    bool closing = false;
+    bool recording = false;
+    WORD old_regs[NUM_REG_WORDS];
+    int old_tape_pos, old_tape_line;
+    char old_last_printed;
+    TICKS old_sim_time;
+    uint64_t old_order_count;
+    std::vector<WORD> writes;       // (address, old value) pairs
+};
+
+#endif
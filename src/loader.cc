@@ -0,0 +1,393 @@
+/*
+ * loader.cc -- definitions for Loader class
+ *              (host-side equivalent of Initial Orders 2)
+ */
+#include "loader.h"
+
+#include "attributes.h"
+#include "cache.h"
+#include "edsac.h"
+#include "input.h"
+#include "settings.h"
+#include "tank.h"
+
+// perforator codes of the characters IO2 treats specially
+static const char FIRST_TERMINATOR = 11;    // # (lowest non-digit)
+static const char Z_CODE = 13;              // Z -- order address += theta
+static const char K_CODE = 14;              // K -- control combination
+static const char STAR_CODE = 15;           // * -- (. sets theta)
+static const char F_CODE = 17;              // F (lowest "parameter" code)
+static const char THETA_CODE = 18;          // @ -- address += theta
+static const char D_CODE = 19;              // D -- long order
+
+static const char T_CODE = 5;               // function codes of orders
+static const char E_CODE = 3;               // ... the loader executes
+
+// lowest address a tape order may be stored in without
+// overwriting the initial orders or their working space
+static const ADDR FIRST_FREE = 44;
+
+// the most orders IO2 runs to read a tape order, besides 9 for each digit
+static const unsigned MOST_ORDERS = 30;
+
+std::vector<Loader::Routine> Loader::routines;
+
+// load from a freshly prepared machine (IO2 in the store, registers clear)
+void Loader::run()
+{
+    if (not room_for(MOST_ORDERS)) { return; }
+
+    // the fixed opening sequence
+    transfer(0, 0);                 // T 0 F
+    step(1);                        // E 20 F
+    step(20);                       // H 8 F
+    edsac->mplier[0] = 0;
+    edsac->mplier[1] = get(8);
+    add(21, 40);                    // A 40 F
+    transfer(22, 43);               // T 43 F
+    add(23, 22);                    // A 22 F
+    add(24, 2);                     // A 2 F
+    transfer(25, 22);               // T 22 F
+    sct = 26;
+
+    // then one tape order (or library routine) at a time, until control
+    // leaves the loop
+    Tape_Reader *input = edsac->input;
+    for (;;) {
+        if (splice()) { continue; }
+        int pos = input->position(), line = input->line();
+        Tape_Order t;
+        if (not read_order(input, t) or not modelled(t)     // leave it to IO2
+            or not room_for(MOST_ORDERS + 9*t.num_digits))
+        {
+            input->set_position(pos, line);
+            break;
+        }
+        if (not load_order(t)) { break; }
+    }
+    finish();
+}
+
+// remember the text of a library routine inserted into a tape
+// (unless, after any control combinations heading it, it has orders
+// other than ones stored with the F, theta, or D terminator)
+void Loader::add_routine(const QString& text)
+{
+    Routine r;
+    r.ignore_case = Settings::ignore_case();
+    r.relocated = r.long_words = false;
+    r.num_digits = 0;
+    int start = -1;
+    Tape_Reader reader;
+    reader.set_up_tape(text);
+    for (;;) {
+        int pos = reader.position(), line = reader.line();
+        Tape_Order t;
+        if (not read_order(&reader, t)) {   // must end between orders
+            reader.set_position(pos, line);
+            if (reader.next_char(false) != Tape_Reader::ENDFILE) { return; }
+            break;
+        }
+        if (start < 0 and t.term < F_CODE) { continue; }    // (heading)
+        if (t.term != F_CODE and t.term != THETA_CODE and t.term != D_CODE) {
+            return;
+        }
+        if (start < 0) { start = pos; }
+
+        // as IO2 adds number, parameter (0, theta, or 1), and function
+        WORD w = WORD(t.func) << (ADDR_BITS + FLAG_BITS);
+        w = (w + t.number + (t.term == D_CODE)) & MAX_HIWORD;
+        r.words.push_back(w);
+        r.relative.push_back(t.term == THETA_CODE);
+        r.relocated = r.relocated or t.term == THETA_CODE;
+        r.long_words = r.long_words or t.term == D_CODE;
+        r.num_digits += t.num_digits;
+        r.last = t;
+    }
+    if (r.words.empty()) { return; }
+
+    while (text[start].isSpace()) { ++start; }
+    r.text = text.mid(start);
+    r.lines = r.text.count(QChar('\n'));
+    for (const Routine& known : routines) {
+        if (known.text == r.text and known.ignore_case == r.ignore_case) {
+            return;
+        }
+    }
+    routines.push_back(r);
+}
+
+// read the next order from the tape: function, digits, and terminating
+// character (false, quietly, on a tape error)
+bool Loader::read_order(Tape_Reader *input, Tape_Order& t)
+{
+    t.func = input->next_char(false);
+    if (t.func < 0) { return false; }
+    t.number = 0;
+    t.num_digits = 0;
+    while ((t.term = input->next_char(false)) < FIRST_TERMINATOR) {
+        if (t.term < 0) { return false; }
+        t.number = (10*t.number + 2*t.term) & MAX_HIWORD;
+        ++t.num_digits;
+    }
+    return true;
+}
+
+// the library routine whose text starts at pos on the tape, if any
+// (after any white space, which pos and line are moved past)
+const Loader::Routine *Loader::routine_at(int& pos, int& line) const
+{
+    const QString& tape = edsac->input->text();
+    int p = pos, n = line;
+    while (p < tape.size() and tape[p].isSpace()) {
+        if (tape[p] == '\n') { ++n; }
+        ++p;
+    }
+    if (p == tape.size()) { return nullptr; }
+    for (const Routine& r : routines) {
+        if (r.text[0] == tape[p] and r.ignore_case == Settings::ignore_case()
+            and tape.midRef(p, r.text.size()) == r.text)
+        {
+            pos = p;
+            line = n;
+            return &r;
+        }
+    }
+    return nullptr;
+}
+
+// if the orders of a known library routine start here on the tape, and
+// IO2 is storing orders one after another, store them all at once as IO2
+// would (true if so)
+bool Loader::splice()
+{
+    int pos = edsac->input->position(), line = edsac->input->line();
+    const Routine *r = routine_at(pos, line);
+    if (r == nullptr) { return false; }
+
+    // IO2 stores by the T a F in 22, stepped by the P 1 F in 2 (and adds
+    // the P 0 D in 43 for the D terminator); a word at a time otherwise
+    WORD next = get(22), step_by = get(2);
+    ADDR a = (next >> FLAG_BITS) & MAX_ADDR;
+    unsigned n = r->words.size();
+    if (next >> (ADDR_BITS + FLAG_BITS) != T_CODE or (next & MAX_FLAG) != 0
+        or a < FIRST_FREE or a + n - 1 > MAX_ADDR
+        or step_by != WORD(1) << FLAG_BITS
+        or (r->long_words and get(43) != 1))
+    {
+        return false;
+    }
+
+    // the A order IO2 plants in 20 for the last order (those for the
+    // others differ only in their addresses)
+    const Tape_Order& t = r->last;
+    WORD planted = ((t.term - get(39)) & MAX_HIWORD) << 1;
+    planted = (planted - get(39) + get(35)) & MAX_HIWORD;
+
+    // the orders IO2 runs for each word (E 34 F at 26 before each, but
+    // not the first if control combinations left control at 34), and for
+    // each digit punched
+    static const ADDR PER_WORD[] = { 34, 35, 36, 37, 38, 8, 9, 10, 11, 12,
+                                     13, 14, 15, 17, 18, 19, 21, 23, 24, 25 };
+    static const ADDR PER_DIGIT[] = { 8, 9, 10, 11, 12, 4, 5, 6, 7 };
+    auto time = [](WORD order)
+        { return Edsac::timings[order >> (ADDR_BITS + FLAG_BITS)]; };
+    TICKS per_word = time(planted) + time(next);    // (20 and 22)
+    for (ADDR at : PER_WORD) { per_word += time(get(at)); }
+    uint64_t restarts = (sct == 26) ? n : n - 1;
+    uint64_t run = n * (sizeof PER_WORD / sizeof PER_WORD[0] + 2) + restarts
+                   + r->num_digits * (sizeof PER_DIGIT / sizeof PER_DIGIT[0]);
+    if (not room_for(run)) { return false; }
+    TICKS spent = n * per_word + restarts * time(get(26));
+    if (r->num_digits > 0) {
+        TICKS per_digit = 0;
+        for (ADDR at : PER_DIGIT) { per_digit += time(get(at)); }
+        spent += r->num_digits * per_digit;
+    }
+
+    // the words, then those theta relocates
+    for (unsigned k = 0; k < n; k++) { set(a + k, r->words[k]); }
+    if (r->relocated) {
+        WORD theta = get(42);
+        for (unsigned k = 0; k < n; k++) {
+            if (r->relative[k]) {
+                set(a + k, (r->words[k] + theta) & MAX_HIWORD);
+            }
+        }
+    }
+
+    // what IO2's working locations are left holding by the last order
+    set(0, t.number);
+    set(1, t.term);
+    set(20, planted);
+    set(40, WORD(t.func) << (ADDR_BITS + FLAG_BITS));
+    set(41, 0);
+    set(22, (next + n*step_by) & MAX_HIWORD);
+    orders += run;
+    ticks += spent;
+
+    acc = 0;
+    mcand = step_by;
+    order = get(25);
+    sct = 26;
+    edsac->input->set_position(pos + r->text.size(), line + r->lines);
+    return true;
+}
+
+// true if n more orders keep within the limit the machine is loading to
+bool Loader::room_for(uint64_t n) const
+{
+    return edsac->order_count + orders + n <= edsac->order_limit;
+}
+
+// true if the loader can do what IO2 does for tape order t
+bool Loader::modelled(const Tape_Order& t)
+{
+    if (t.term >= F_CODE) { return true; }      // (stored in the store)
+    return t.term >= Z_CODE and (t.number & SIGN_BIT) == 0;
+}
+
+// apply the orders IO2 runs for tape order t, starting at 26 (or 34)
+// (true if back at the start of the loop; false if control has left it)
+bool Loader::load_order(const Tape_Order& t)
+{
+    if (sct == 26) { step(26); }    // E 34 F
+
+    // function letter, shifted into the function bits of 40
+    step(34);                       // I 40 D
+    set(40, 0);
+    set(41, t.func);
+    step(35);                       // A 40 D
+    mcand = acc = t.func;
+    step(36);                       // R 16 F
+    step(37);                       // T 40 D
+    set(40, WORD(t.func) << (ADDR_BITS + FLAG_BITS));
+    set(41, 0);
+    acc = 0;
+    step(38);                       // E 8 F
+
+    // digits: 0 := 10 * 0 + 2 * digit (only the last pass through the
+    // loop leaves anything the terminating character does not overwrite)
+    for (unsigned i = 0; i < t.num_digits; i++) {
+        for (ADDR at : { 8, 9, 10, 11, 12, 4, 5, 6, 7 }) { step(at); }
+    }
+    if (t.num_digits > 0) {
+        acc = t.number;
+        mcand = 0;                  // (cleared by V 0 F)
+    }
+
+    // terminating character: plant "A (term+24) F" or "E (term+16) F"
+    // in 20, then add number, parameter, and function into 22
+    transfer(8, 0);                 // T 0 F
+    step(9);                        // I 1 F
+    set(1, t.term);
+    add(10, 1);                     // A 1 F
+    subtract(11, 39);               // S 39 F
+    step(12);                       // G 4 F
+    step(13);                       // L 0 D
+    acc = (2*acc) & MAX_HIWORD;
+    subtract(14, 39);               // S 39 F
+    step(15);                       // E 17 F
+    if (t.term < F_CODE) { subtract(16, 7); }   // S 7 F
+    add(17, 35);                    // A 35 F
+    transfer(18, 20);               // T 20 F
+    add(19, 0);                     // A 0 F
+    if (t.term < F_CODE) {
+        step(20);                   // E (term+16) F
+        if (t.term == Z_CODE) { add(29, 42); }          // A 42 F
+        if (t.term <= K_CODE) { add(30, 40); }          // A 40 F
+        if (t.term <= STAR_CODE) {
+            step(31);               // E 25 F
+            if ((acc & SIGN_BIT) == 0) {
+                transfer(25, 22);   // T 22 F: next store address
+                sct = 26;
+                return true;
+            }
+        }
+        add(32, 22);                // A 22 F
+        transfer(33, 42);           // T 42 F: theta := store address
+        sct = 34;
+        return true;
+    }
+    add(20, t.term + 24);           // A (term+24) F
+    add(21, 40);                    // A 40 F
+
+    // the assembled order goes where the order in 22 says
+    sct = 22;
+    WORD w = get(22);
+    int func = w >> (ADDR_BITS + FLAG_BITS);
+    ADDR a = (w >> FLAG_BITS) & MAX_ADDR;
+    if (func == T_CODE and (w & MAX_FLAG) == 0 and a >= FIRST_FREE) {
+        transfer(22, a);            // T a F
+        add(23, 22);                // A 22 F
+        add(24, 2);                 // A 2 F
+        transfer(25, 22);           // T 22 F
+        sct = 26;
+        return true;
+    }
+    if (func == E_CODE) {           // E a F: usually the end of the tape
+        step(22);
+        sct = ((acc & SIGN_BIT) == 0) ? a : 23;
+    }
+    return false;
+}
+
+// leave the machine as IO2 would have at this point
+void Loader::finish()
+{
+    edsac->acc.clear();
+    edsac->acc[3] = acc;
+    edsac->mcand[0] = 0;
+    edsac->mcand[1] = mcand;
+    edsac->order[0] = order;
+    edsac->sct[0] = sct;
+    edsac->sim_time += ticks;
+    edsac->order_count += orders;
+}
+
+// count the order at location at as executed
+void Loader::step(ADDR at)
+{
+    order = get(at);
+    ticks += Edsac::timings[order >> (ADDR_BITS + FLAG_BITS)];
+    ++orders;
+}
+
+// A a F (at location at)
+void Loader::add(ADDR at, ADDR a)
+{
+    step(at);
+    mcand = get(a);
+    acc = (acc + mcand) & MAX_HIWORD;
+}
+
+// S a F (at location at)
+void Loader::subtract(ADDR at, ADDR a)
+{
+    step(at);
+    mcand = get(a);
+    acc = (acc - mcand) & MAX_HIWORD;
+}
+
+// T a F (at location at)
+void Loader::transfer(ADDR at, ADDR a)
+{
+    step(at);
+    set(a, acc);
+    acc = 0;
+}
+
+// get the word at store location (a)
+WORD Loader::get(ADDR a)
+{
+    WORD value = word_at(&edsac->store[tank_num(a)], a & OFFSET_MASK);
+    edsac->cache->note_read(a, value);
+    return value;
+}
+
+// set value as the contents of store location (a)
+void Loader::set(ADDR a, WORD value)
+{
+    edsac->cache->note_write(a);
+    store_word_at(&edsac->store[tank_num(a)], a & OFFSET_MASK, value);
+}
@@ -0,0 +1,95 @@
+/*
+ * loader.h -- declarations for Loader class
+ *             (host-side equivalent of Initial Orders 2)
+ */
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <QString>
+
+#include <vector>
+
+#include "attributes.h"
+
+class Edsac;
+class Tape_Reader;
+
+// Reads orders from the tape into the store as Initial Orders 2 would,
+// without interpreting the initial orders one at a time.  Each tape
+// order is parsed ahead, then the orders IO2 would run for it are
+// applied as closed-form steps, so the store, registers, tape position,
+// order count, and time all end exactly as if IO2 had run.  Anything
+// not modelled (the # and S terminators, a store into the
+// initial orders themselves, a tape error) stops the loader at the last
+// order boundary, leaving the rest to the simulator.
+//
+// Library routines inserted into a tape are assembled once, into the
+// words their orders store (relative to theta) with a bit for each that
+// theta relocates.  Wherever a routine's orders turn up unchanged on the
+// tape, while IO2 is storing orders one after another, the loader copies
+// these words into place, relocates the marked ones, and counts the
+// orders and time IO2 would take over them all at once.  (Control
+// combinations heading the routine, as its GK, are read as usual.)
+class Loader
+{
+public:
+    Loader(Edsac *e) : edsac(e) {}
+
+    // load from a freshly prepared machine
+    void run();
+
+    // remember the text of a library routine inserted into a tape
+    static void add_routine(const QString& text);
+private:
+    // one tape order, as punched
+    struct Tape_Order {
+        char func;
+        WORD number;        // twice the decimal number, as IO2 builds it
+        unsigned num_digits;
+        char term;
+    };
+
+    // a library routine, as the words its orders store
+    struct Routine {
+        QString text;               // from its first stored order on
+        int lines;                  // # line breaks in the text
+        bool ignore_case;
+        std::vector<WORD> words;    // assembled for theta = 0
+        std::vector<bool> relative; // ... and which theta relocates
+        bool relocated;             // (any of them)
+        bool long_words;            // (any with the D terminator)
+        unsigned num_digits;        // # digits punched, in all
+        Tape_Order last;            // (IO2's working locations hold it)
+    };
+
+    static bool read_order(Tape_Reader *input, Tape_Order& t);
+    static bool modelled(const Tape_Order& t);
+    const Routine *routine_at(int& pos, int& line) const;
+    bool splice();
+    bool load_order(const Tape_Order& t);
+    void finish();
+
+    bool room_for(uint64_t n) const;
+
+    // effects of single IO2 orders on the modelled registers
+    // (the accumulator holds only a short number between tape orders)
+    void step(ADDR at);
+    void add(ADDR at, ADDR a);
+    void subtract(ADDR at, ADDR a);
+    void transfer(ADDR at, ADDR a);
+    WORD get(ADDR a);
+    void set(ADDR a, WORD value);
+
+    static std::vector<Routine> routines;
+
+    Edsac *edsac;
+
+    WORD acc = 0;           // high word of accumulator (the rest is 0)
+    WORD mcand = 0;         // low word of multiplicand (the rest is 0)
+    WORD order = 0;
+    ADDR sct = 0;
+    TICKS ticks = 0;
+    uint64_t orders = 0;
+};
+
+#endif
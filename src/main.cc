@@ -4,7 +4,9 @@
 #include <QString>
 #include <QTimer>
 
+#include "headless.h"
 #include "menu.h"
+#include "sound.h"
 
 static const QString STYLE = 
     #if defined(_WIN32) or defined(_WIN64)
@@ -19,6 +21,9 @@ extern QClipboard *clipboard;   // defined in editor.cc, but initialized below
 
 int main(int argc, char *argv[])
 {
+    // command-line runs don't need (or want) any windows
+    if (Headless::requested(argc, argv)) { return Headless::run(argc, argv); }
+
     QApplication app(argc, argv);  
 
     app.setWindowIcon(QIcon(":/logo.png"));     // set app-wide icon
@@ -29,6 +34,9 @@ int main(int argc, char *argv[])
 
     clipboard = QGuiApplication::clipboard();
 
+    // sounds are decoded once, and played on their own thread
+    start_sound();
+
     // show splash screen
     QPixmap pixmap(":/splash.png");
     QSplashScreen splash(pixmap, Qt::WindowStaysOnTopHint);
@@ -42,5 +50,7 @@ int main(int argc, char *argv[])
     menu = new Menu();
     QTimer::singleShot(1500, menu, SLOT(show()));
 
-    return app.exec();
+    int status = app.exec();
+    stop_sound();
+    return status;
 }
@@ -11,6 +11,7 @@
 #include <QFrame>
 #include <QHBoxLayout>
 #include <QIcon>
+#include <QInputDialog>
 #include <QLabel>
 #include <QLineEdit>
 #include <QMenuBar>
@@ -26,14 +27,18 @@
 #include <QUrl>
 #include <QVBoxLayout>
 
+#include <climits>
+
 #include "menu.h"
 
 #include "about.h"
 #include "display.h"
 #include "editor.h"
 #include "error.h"
+#include "loader.h"
 #include "edsac.h"
 #include "options.h"
+#include "postmortem.h"
 #include "settings.h"
 
 // document locations
@@ -41,6 +46,17 @@ static const QString TUTORIAL_URL = "file://" DOC_DIR "/EdsacTG.pdf";
 static const QString EDSACDOC_URL = "file://" DOC_DIR "/EdsacDoc.pdf";
 static const QString WWG1951_URL = "file://" DOC_DIR "/WWG1951.pdf";
 
+// choices for "speed" option (multiples of real time; 0 = full speed)
+static const int SPEEDS[] = { 1, 2, 10, 100, 0 };
+
+// name of speed s in the options bar
+static QString speed_name(int s)
+{
+    if (s == 0) { return "Full Speed"; }
+    else if (s == 1) { return "Real Time"; }
+    return QString::number(s) + "× Real Time";
+}
+
 Menu *menu;     // single menu/toolbar window for simulator
                 // (initialized in main)
 
@@ -362,6 +378,49 @@ Menu::Menu(QWidget *parent)
     cc_lt_down->setShortcut(tr("Ctrl+Shift+D"));
     cc_lt_down->setShortcutContext(Qt::ApplicationShortcut);
 
+    // "Run" submenu (full speed, display updated when done)
+    QMenu *run_until = edsac_menu->addMenu("R&un");
+    QAction *run_n = run_until->addAction("Run &N Orders...");
+    connect(run_n, &QAction::triggered,
+            [this]() {
+                bool ok;
+                int n = QInputDialog::getInt(this, "Run N Orders",
+                    "Number of orders:", 1000, 1, INT_MAX, 1, &ok);
+                if (ok) { edsac->run_orders(n); }
+            });
+    QAction *run_addr = run_until->addAction("Run Until &Sequence Control...");
+    connect(run_addr, &QAction::triggered,
+            [this]() {
+                bool ok;
+                int a = QInputDialog::getInt(this, "Run Until Address",
+                    "Sequence control address:", 0, 0, MAX_ADDR, 1, &ok);
+                if (ok) { edsac->run_to_address(a); }
+            });
+    QAction *run_print = run_until->addAction("Run Until Next &O Order");
+    connect(run_print, &QAction::triggered,
+            []() { edsac->run_to_print(); });
+    QAction *run_output = run_until->addAction("Run Until &Output...");
+    connect(run_output, &QAction::triggered,
+            [this]() {
+                bool ok;
+                QString text = QInputDialog::getText(this, "Run Until Output",
+                    "Output text:", QLineEdit::Normal, "", &ok);
+                if (ok and not text.isEmpty()) { edsac->run_to_output(text); }
+            });
+    run_until->addSeparator();
+    QAction *step_back = run_until->addAction("Step &Back");
+    connect(step_back, &QAction::triggered, edsac, &Edsac::step_back);
+    step_back->setShortcut(tr("Ctrl+Shift+B"));
+    step_back->setShortcutContext(Qt::ApplicationShortcut);
+    QAction *run_back = run_until->addAction("Run Backwards &To...");
+    connect(run_back, &QAction::triggered,
+            [this]() {
+                bool ok;
+                int a = QInputDialog::getInt(this, "Run Backwards",
+                    "Sequence control address:", 0, 0, MAX_ADDR, 1, &ok);
+                if (ok) { edsac->run_back_to(a); }
+            });
+
     // "Dial" submenu
     // should we use an array & loop for dial_digits?
     // (and does it matter now?)
@@ -406,7 +465,33 @@ Menu::Menu(QWidget *parent)
     connect(digit_9, &QAction::triggered, []() { edsac->dial_digit(9); });
     digit_9->setShortcut(tr("F9"));
     digit_9->setShortcutContext(Qt::ApplicationShortcut);
-    
+
+    // "Post-Mortem" submenu (the store as the PM routines print it,
+    // shown in a new edit window)
+    QMenu *post_mortem = edsac_menu->addMenu("Post-&Mortem");
+    for (int i = 0; i < Post_Mortem::NUM_FORMATS; i++) {
+        Post_Mortem::Format f = Post_Mortem::Format(i);
+        QAction *pm = post_mortem->addAction(Post_Mortem::name(f) + "...");
+        connect(pm, &QAction::triggered,
+            [this, f]() {
+                bool ok;
+                QString range = QInputDialog::getText(this, "Post-Mortem",
+                    "Locations (first-last):", QLineEdit::Normal,
+                    QString("0-%1").arg(STORE_WORDS - 1),
+                    &ok);
+                ADDR first, last;
+                if (not ok) { return; }
+                if (not Post_Mortem::parse_range(range, first, last)) {
+                    Error::beep();
+                    return;
+                }
+                Post_Mortem dump(edsac->store_image());
+                Edit_Window *window = new Edit_Window();
+                window->contents()->setPlainText(dump.dump(f, first, last));
+                window->show();
+            });
+    }
+
     edsac_menu->addSeparator();
 
     // "Options" item
@@ -594,11 +679,21 @@ const int OPTION_FONT_SIZE =
         [this]() { Settings::set_stop_bell(bell->isChecked()); } );
 
     options->addStretch();
-    time = new QCheckBox("Real Time");
-    time->setFont(f);
-    options->addWidget(time);
-    connect(time, &QCheckBox::stateChanged,
-        [this]() { Settings::set_real_time(time->isChecked()); } );
+    speed = new QComboBox();
+    speed->setFont(f);
+    for (int s : SPEEDS) { speed->addItem(speed_name(s), s); }
+    options->addWidget(speed);
+    connect(speed, QOverload<int>::of(&QComboBox::currentIndexChanged),
+        [this](int index) {
+            Settings::set_speed(speed->itemData(index).toInt());
+        });
+
+    options->addStretch();
+    turbo = new QCheckBox("Turbo");
+    turbo->setFont(f);
+    options->addWidget(turbo);
+    connect(turbo, &QCheckBox::stateChanged,
+        [this]() { Settings::set_turbo(turbo->isChecked()); } );
 
     options->addStretch();
     sound = new QCheckBox("Sound");
@@ -745,8 +840,10 @@ const int OPTION_FONT_SIZE =
                             if (QMessageBox::question(nullptr, "Confirmation",
                                 "Insert " + name + "?") == QMessageBox::Yes)
                             {
-                                Edit_Window::current_window()->
-                                    insert_file(fname);
+                                // (keep the routine ready for loading)
+                                Loader::add_routine(
+                                    Edit_Window::current_window()->
+                                        insert_file(fname));
                             }
                         };
                     connect(action, &QAction::triggered, to_do);
@@ -911,7 +1008,13 @@ void Menu::sync_options_bar()
 {
     initial->setCurrentIndex(Settings::initial_orders() - 1);
     bell->setChecked(Settings::stop_bell());
-    time->setChecked(Settings::real_time());
+    int index = speed->findData(Settings::speed());
+    if (index < 0) {    // not in the list; add it
+        speed->addItem(speed_name(Settings::speed()), Settings::speed());
+        index = speed->count() - 1;
+    }
+    speed->setCurrentIndex(index);
+    turbo->setChecked(Settings::turbo());
     sound->setChecked(Settings::sound());
     hints->setChecked(Settings::hints());
     tanks->setChecked(Settings::short_tanks());
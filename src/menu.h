@@ -90,7 +90,8 @@ private:
     // option bar widgets
     QComboBox *initial;         // "initial orders" option
     QCheckBox *bell;            // "stop bell" option
-    QCheckBox *time;            // "real time" option
+    QComboBox *speed;           // "speed" option (multiple of real time)
+    QCheckBox *turbo;           // "turbo" option
     QCheckBox *sound;           // "sound" option
     QCheckBox *hints;           // "hints" option
     QCheckBox *tanks;           // "short tanks" option
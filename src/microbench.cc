@@ -0,0 +1,140 @@
+/*
+ * microbench.cc -- definitions for Microbench class
+ *                  (the engine's kernels timed one at a time)
+ */
+#include <QElapsedTimer>
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "microbench.h"
+
+#include "arith.h"
+#include "codes.h"
+#include "edsac.h"
+#include "tank.h"
+
+using Codes::code_of;       // punch code for given letter
+
+static const unsigned OPERANDS = 4096;  // random operands (a power of 2)
+static const unsigned TRIES = 3;        // of each kernel (the best is kept)
+static const unsigned REG_WORDS = 4;    // (as the accumulator)
+
+// the orders obeyed at random: those with no input, output, or stop
+static const char ORDERS[] = "ASHVNTUCRLEGXY";
+
+// the best time of op(i) done n times (i running over the operands), in
+// nanoseconds an operation
+template <typename Op>
+static double best_time(unsigned n, Op op)
+{
+    double best = 0;
+    for (unsigned t = 0; t < TRIES; t++) {
+        QElapsedTimer clock;
+        clock.start();
+        for (unsigned i = 0; i < n; i++) { op(i & (OPERANDS - 1)); }
+        double ns = double(clock.nsecsElapsed()) / n;
+        if (t == 0 or ns < best) { best = ns; }
+    }
+    return best;
+}
+
+// the best time of KERNEL done n times on a copy of the registers in regs,
+// each left as the kernel made it, in nanoseconds an operation
+template <void (*KERNEL)(WORD[], int)>
+static double in_place(unsigned n, std::vector<WORD> regs)
+{
+    WORD *r = regs.data();
+    return best_time(n, [r](unsigned i)
+        { KERNEL(r + REG_WORDS*i, REG_WORDS); });
+}
+
+Microbench::Microbench(Edsac *e)
+    : edsac(e)
+{}
+
+// time every kernel over n operations and print the table; returns the
+// exit status
+int Microbench::run(unsigned n)
+{
+    if (n == 0) { return 0; }
+
+    // the same operands every time, so runs can be compared
+    std::mt19937 random(1949);
+    std::vector<WORD> words(OPERANDS), regs(OPERANDS * REG_WORDS);
+    std::vector<ADDR> addrs(OPERANDS);
+    struct Order { char func; ADDR addr; bool lflag; };
+    std::vector<Order> orders(OPERANDS);
+    for (unsigned i = 0; i < OPERANDS; i++) {
+        words[i] = random() & MAX_HIWORD;
+        for (unsigned j = 0; j < REG_WORDS; j++) {
+            regs[REG_WORDS*i + j] =
+                random() & (j < REG_WORDS - 1 ? MAX_LOWORD : MAX_HIWORD);
+        }
+        addrs[i] = random() & MAX_ADDR;
+        orders[i].func = code_of(ORDERS[random() % (sizeof ORDERS - 1)]);
+        orders[i].addr = random() & MAX_ADDR;
+        orders[i].lflag = (random() & 1) != 0;
+    }
+
+    Edsac *e = edsac;
+    e->load_program(QString());     // (headless, so quiet)
+    for (ADDR a = 0; a <= MAX_ADDR; a++) { e->store_word(a, words[a]); }
+    e->mplier[0] = words[1];
+    e->mplier[1] = words[2];
+    WORD *acc = e->acc.begin();
+    const WORD *reg = regs.data();
+    volatile WORD sink = 0;         // (so no result can go unused)
+
+    printf("%-20s %10s\n", "kernel", "ns/op");
+    auto report = [](const char *name, double ns) {
+        printf("%-20s %10.2f\n", name, ns);
+        fflush(stdout);
+    };
+
+    WORD sum = 0;
+    report("loop", best_time(n, [&](unsigned i) { sum += words[i]; }));
+    sink = sum;
+
+    // arith.h, on the accumulator (each operand is a whole register)
+    report("add_to", best_time(n, [&](unsigned i)
+        { add_to(reg + REG_WORDS*i, acc, REG_WORDS); }));
+    report("subtract_from", best_time(n, [&](unsigned i)
+        { subtract_from(reg + REG_WORDS*i, acc, REG_WORDS); }));
+    report("negate", in_place<negate>(n, regs));
+    report("shift_left", in_place<shift_left>(n, regs));
+    report("shift_right", in_place<shift_right>(n, regs));
+    report("add_number", best_time(n, [&](unsigned i)
+        { add_number(acc, words[i], words[(i + 1) & (OPERANDS - 1)]); }));
+    sink = sink + acc[3];
+
+    // the store, and the multiplicand and multiplier registers
+    sum = 0;
+    report("get_word", best_time(n, [&](unsigned i)
+        { sum += e->get_word(addrs[i]); }));
+    sink = sink + sum;
+    report("store_word", best_time(n, [&](unsigned i)
+        { e->store_word(addrs[i], words[i]); }));
+    report("load_mcand (short)", best_time(n, [&](unsigned i)
+        { e->load_mcand<false>(addrs[i]); }));
+    report("load_mcand (long)", best_time(n, [&](unsigned i)
+        { e->load_mcand<true>(addrs[i]); }));
+    report("mult_op (short)", best_time(n, [&](unsigned i)
+        { e->mult_op<false>(addrs[i], Edsac::ADDITION); }));
+    report("mult_op (long)", best_time(n, [&](unsigned i)
+        { e->mult_op<true>(addrs[i], Edsac::SUBTRACTION); }));
+    report("multiply_numbers", best_time(n, [&](unsigned i)
+        { multiply_numbers(acc, long_word(words[i], words[addrs[i]]),
+                           long_word(e->mplier[0], e->mplier[1]), false); }));
+    sink = sink + acc[3];
+
+    // whole orders, through the jump table
+    const char X = code_of('X');
+    report("obey (X)", best_time(n, [&](unsigned i)
+        { e->obey(X, addrs[i], false); }));
+    report("obey (mixed)", best_time(n, [&](unsigned i)
+        { const Order& o = orders[i]; e->obey(o.func, o.addr, o.lflag); }));
+    sink = sink + acc[3];
+    return 0;
+}
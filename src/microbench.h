@@ -0,0 +1,31 @@
+/*
+ * microbench.h -- declarations for Microbench class
+ *                 (the engine's kernels timed one at a time)
+ */
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+class Edsac;
+
+// Times the small pieces every order is built from, each on its own:
+// the multi-word arithmetic of arith.h, multiplication and the loading
+// of the multiplicand, reading and writing the store, and obeying an
+// order through the jump table.  Each is done n times over random
+// operands made beforehand, and its best time of a few tries printed in
+// nanoseconds an operation, with the cost of the loop itself (and of
+// fetching the operands) shown first, so a change to any one kernel can
+// be measured apart from the rest.  Needs no tape; leaves the machine's
+// registers and store full of random numbers.
+class Microbench
+{
+public:
+    Microbench(Edsac *e);
+
+    // time every kernel over n operations and print the table; returns
+    // the exit status
+    int run(unsigned n);
+private:
+    Edsac *edsac;
+};
+
+#endif
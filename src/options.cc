@@ -148,7 +148,9 @@ void Options::accept()
     Settings::set_stop_bell(stop_bell->isChecked());
     Settings::set_sound(sound->isChecked());
     Settings::set_hints(hints->isChecked());
-    Settings::set_real_time(real_time->isChecked());
+    if (real_time->isChecked() != Settings::real_time()) {
+        Settings::set_real_time(real_time->isChecked());   // keeps speed
+    }
     Settings::set_short_tanks(short_tanks->isChecked());
     // note conversion of bool to int in setting initial orders number:
     Settings::set_initial_orders(orders[0]->isChecked()
@@ -203,6 +205,8 @@ void Options::save_options() const
     settings.setValue("StartUp/AutoOpenRecent", open_recent->isChecked());
     settings.setValue("ToolBarPresets/Sound", sound->isChecked());
     settings.setValue("ToolBarPresets/RealTime", real_time->isChecked());
+    settings.setValue("ToolBarPresets/Speed", not real_time->isChecked() ? 0
+                        : Settings::real_time() ? Settings::speed() : 1);
     settings.setValue("ToolBarPresets/Hints", hints->isChecked());
     settings.setValue("ToolBarPresets/ShortTanks", short_tanks->isChecked());
     settings.setValue("Other/Stop_bell", stop_bell->isChecked());
@@ -6,29 +6,32 @@
 
 #include "output.h"
 
+#include "codes.h"
 #include "display.h"
 #include "menu.h"
 #include "settings.h"
 #include "sound.h"
 
-// translation table for EDSAC teleprinter characters
-// (lowercase for control chars)
-static const QString TRANSTAB[2] = {
-    "PQWERTYUIOJf" "S"  "ZKlxFrD HNMnLXGABCV",      // letter shift
-    "0123456789bf" "\"" "+(lx$r; £,.n)/#-?:=",      // figure shift
-};
+const char Teleprinter::LINEFEED = Codes::find(Codes::PRINTED[0], 'n');
 
-const char Teleprinter::LINEFEED = TRANSTAB[0].indexOf('n');
-
-static const QString LITERAL_CHARS ="PQWERTYUIOJ#SZK*.F@D!HNM&LXGABCV";
+// translate EDSAC character c, keeping track of letter/figure shift
+QChar Teleprinter::translate(char c, Shift_Mode& mode)
+{
+    QChar qc = QChar(ushort(Codes::PRINTED[mode][int(c)]));
+    if (qc == 'f') { mode = FIGURES; }
+    else if (qc == 'l') { mode = LETTERS; }
+    return qc;
+}
 
 // print specified EDSAC character on the teleprinter
-void Teleprinter::do_print(char c)
+// (quietly: no sounds, and no repaint until the event loop gets to it)
+void Teleprinter::do_print(char c, bool quietly)
 {   
+    bool sounds = Settings::teleprinter_sound() and not quietly;
     if (Settings::literal_output()) {
         static int columns = 0;
         ensureCursorVisible();
-        insertPlainText(LITERAL_CHARS[c]);
+        insertPlainText(QString(QChar(Codes::PUNCH[int(c)])));
         columns = (columns + 1) % 4;
         if (columns == 0) { insertPlainText("\n"); }
         menu->enable(PRINT_OUTPUT, true);
@@ -36,19 +39,16 @@ void Teleprinter::do_print(char c)
         menu->enable(DISCARD_OUTPUT, true);
         menu->enable(DISCARD_OUTPUT_TOOL, true);
     } else {
-        QChar qc = TRANSTAB[shift][c];
+        QChar qc = translate(c, shift);
         if (qc.isLower()) {     // control char
             int col = textCursor().columnNumber();
             switch (qc.toLatin1()) {
                 case 'f':       // figure shift
-                    shift = FIGURES;
-                    break;
                 case 'l':       // letter shift
-                    shift = LETTERS;
-                    break;
+                    break;      // (handled by translate)
                 case 'n':       // linefeed ("\n")
-                    if (Settings::teleprinter_sound()) {
-                        play_sound(":/Linefeed.wav", 100);
+                    if (sounds) {
+                        play_sound(":/Linefeed.wav");
                     }
                     moveCursor(QTextCursor::EndOfLine);
                     insertPlainText("\n");
@@ -56,14 +56,14 @@ void Teleprinter::do_print(char c)
                     ensureCursorVisible();
                     break;
                 case 'r':       // carriage return ("\r")
-                    if (Settings::teleprinter_sound()) {
-                        play_sound(":/C_return.wav", 100);
+                    if (sounds) {
+                        play_sound(":/C_return.wav");
                     }
                     moveCursor(QTextCursor::StartOfLine);
                     ensureCursorVisible();
                     break;
                 case 'b':       // bell
-                    if (Settings::teleprinter_sound()) {
+                    if (sounds) {
                         play_sound(":/TeleprinterBell.wav");
                     }
                     break;
@@ -71,8 +71,8 @@ void Teleprinter::do_print(char c)
                     break;
             };
         } else {
-            if (Settings::teleprinter_sound()) {
-                play_sound(qc == ' ' ? ":/Space.wav" : ":/Print.wav", 100);
+            if (sounds) {
+                play_sound(qc == ' ' ? ":/Space.wav" : ":/Print.wav");
             }
             moveCursor(QTextCursor::Right, QTextCursor::KeepAnchor);
             insertPlainText(qc);
@@ -83,5 +83,5 @@ void Teleprinter::do_print(char c)
             menu->enable(DISCARD_OUTPUT_TOOL, true);
         }
     }
-    repaint();
+    if (not quietly) { repaint(); }
 }
@@ -12,17 +12,22 @@ class Teleprinter : public QPlainTextEdit
 public:
     static const char LINEFEED;
 
+    enum Shift_Mode {LETTERS = 0, FIGURES = 1};
+
+    // translate EDSAC character c in the given shift mode (control
+    // characters are lowercase; shift characters change the mode)
+    static QChar translate(char c, Shift_Mode& mode);
+
     Teleprinter(QWidget *parent = nullptr)
         : QPlainTextEdit(parent) { setOverwriteMode(true); }
     
-    void do_print(char c);
+    void do_print(char c, bool quietly = false);
 protected:
     // the following prevent clicks from interfering w/output
     void mousePressEvent(QMouseEvent *e) {}
     void mouseReleaseEvent(QMouseEvent *e) {}
     void mouseDoubleClickEvent(QMouseEvent *e) {}
 private:
-    enum Shift_Mode {LETTERS = 0, FIGURES = 1};
     Shift_Mode shift = LETTERS;         // letter shift at start
 };
 
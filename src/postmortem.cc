@@ -0,0 +1,116 @@
+/*
+ * postmortem.cc -- definitions for Post_Mortem class
+ *                  (host-side store dumps, as printed by PM0-PM5)
+ */
+#include <QByteArray>
+#include <QStringList>
+
+#include "postmortem.h"
+
+#include "attributes.h"
+#include "codes.h"
+#include "decimal.h"
+#include "settings.h"
+
+// PM1 and PM2 fractions: signed, without a leading zero, and truncated
+static const unsigned PM_FRACTION =
+    Decimal::PLUS | Decimal::BARE_POINT | Decimal::TRUNCATE;
+
+// room for the longest line (an address, then a long fraction)
+static const size_t LINE_SIZE = 8 + Decimal::fraction_size(11);
+
+// function letter for code f (as in the display tube hints)
+static inline QChar func_letter(unsigned f)
+    { return QChar(ushort(Codes::LETTERS[f])); }
+
+// the store from first to last (inclusive) in format f
+// (each line is built in a buffer, and the dump made a string once)
+QString Post_Mortem::dump(Format f, ADDR first, ADDR last) const
+{
+    if (f == LETTERS) {         // PM0: every word, no line breaks
+        QString result;
+        result.reserve(last - first + 2);
+        for (unsigned a = first; a <= last; a++) {
+            result += func_letter(
+                (word(a) & MAX_HIWORD) >> (ADDR_BITS + FLAG_BITS));
+        }
+        return result + "\n";
+    }
+
+    bool is_long = (f == LONG_FRACTIONS or f == LONG_INTEGERS);
+    if (is_long) { first &= ~ADDR(1); }
+    int initial_orders = Settings::initial_orders();
+    QByteArray result;
+    char line[LINE_SIZE];
+    for (unsigned a = first; a <= last; a += 1 + is_long) {
+        WORD low = is_long ? word(a) : 0, high = word(a + is_long);
+        if (low == 0 and high == 0) { continue; }   // (as the routines do)
+        char *p = line;
+        if (f == ORDERS) {
+            p = Decimal::integer(p, a, 5, Decimal::SPACES);
+            p = Decimal::text(p, "  ");
+            p = Decimal::order(p, high, initial_orders, 4);
+        } else {
+            p = Decimal::integer(p, a, 3);
+            p = Decimal::text(p, "  ");
+        }
+        switch (f) {
+            case SHORT_FRACTIONS:
+                p = Decimal::fraction(p, high, HIWORD_BITS, 6, PM_FRACTION);
+                break;
+            case LONG_FRACTIONS:
+                p = Decimal::fraction(p, long_word(low, high), LONGWORD_BITS,
+                                      11, PM_FRACTION);
+                break;
+            case SHORT_INTEGERS:
+                p = Decimal::integer(p, sign_extend(high), 6, Decimal::PLUS);
+                break;
+            case LONG_INTEGERS:
+                p = Decimal::integer(p, sign_extend(low, high), 11,
+                                     Decimal::PLUS);
+                break;
+            default:
+                break;
+        }
+        *p++ = '\n';
+        result.append(line, p - line);
+    }
+    return QString::fromUtf8(result);
+}
+
+// "PMn - what it prints" (as in the library catalog)
+QString Post_Mortem::name(Format f)
+{
+    static const char *const what[] = {
+        "Print function letters", "Print short fractions",
+        "Print long fractions", "Print short integers",
+        "Print long integers", "Print orders"
+    };
+    return QString("PM%1 - %2").arg(int(f)).arg(what[f]);
+}
+
+// parse "first-last" (or just "first", meaning to the end of the store);
+// false if it isn't a valid range
+bool Post_Mortem::parse_range(const QString& s, ADDR& first, ADDR& last)
+{
+    QStringList ends = s.split('-');
+    bool ok1, ok2 = true;
+    unsigned f = ends[0].trimmed().toUInt(&ok1);
+    unsigned l = (ends.size() > 1) ? ends[1].trimmed().toUInt(&ok2)
+                                   : STORE_WORDS - 1;
+    if (not ok1 or not ok2 or ends.size() > 2 or f > l or l >= STORE_WORDS) {
+        return false;
+    }
+    first = f;
+    last = l;
+    return true;
+}
+
+// order in word w, laid out as PM5 prints it
+// (the address is left blank when it is zero)
+QString Post_Mortem::order(WORD w)
+{
+    char text[Decimal::ORDER_SIZE];
+    char *end = Decimal::order(text, w, Settings::initial_orders(), 4);
+    return QString::fromUtf8(text, end - text);
+}
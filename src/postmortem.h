@@ -0,0 +1,49 @@
+/*
+ * postmortem.h -- declarations for Post_Mortem class
+ *                 (host-side store dumps, as printed by PM0-PM5)
+ */
+#ifndef POSTMORTEM_H
+#define POSTMORTEM_H
+
+#include <QString>
+
+#include <vector>
+
+#include "attributes.h"
+
+// Formats a range of a copy of the store the way the post-mortem routines
+// in the library print it: PM0 as a continuous line of function letters,
+// PM1-PM5 as one line per location (or pair, for long numbers) holding
+// anything but zero.  Numbers are exact (fractions truncated, as the
+// routines do), so values the routines garble (-1, or addresses above
+// 999) come out correctly.
+class Post_Mortem
+{
+public:
+    // numbered as the library routines
+    enum Format {
+        LETTERS, SHORT_FRACTIONS, LONG_FRACTIONS, SHORT_INTEGERS,
+        LONG_INTEGERS, ORDERS, NUM_FORMATS
+    };
+
+    Post_Mortem(const std::vector<WORD>& image) : store(image) {}
+
+    // the store from first to last (inclusive) in format f
+    QString dump(Format f, ADDR first, ADDR last) const;
+
+    // "PMn - what it prints" (as in the library catalog)
+    static QString name(Format f);
+
+    // parse "first-last" (or just "first", meaning to the end of the
+    // store); false if it isn't a valid range
+    static bool parse_range(const QString& s, ADDR& first, ADDR& last);
+
+    // order in word w, laid out as PM5 prints it
+    static QString order(WORD w);
+private:
+    WORD word(ADDR a) const { return store[a % store.size()]; }
+
+    std::vector<WORD> store;
+};
+
+#endif
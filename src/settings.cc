@@ -7,7 +7,6 @@
 #include "settings.h"
 
 bool Settings::_stop_bell = false;
-bool Settings::_real_time = false;
 bool Settings::_sound = true;
 bool Settings::_hints = false;
 bool Settings::_short_tanks = true;
@@ -20,7 +19,21 @@ bool Settings::_literal_output = false;
 
 bool Settings::_st_suppress = false;
 
+bool Settings::_turbo = false;
+
+bool Settings::_headless = false;
+
+bool Settings::_native_loader = true;
+bool Settings::_load_cache = true;
+bool Settings::_intrinsics = false;
+bool Settings::_jit = false;
+bool Settings::_fusion = false;
+
 int Settings::_long_tank = 0;
+int Settings::_speed = 0;
+
+int Settings::_journal_depth = 100000;
+int Settings::_journal_interval = 1000;
 
 int Settings::_initial_orders = 2;
 int Settings::_scale_factor = 100;
@@ -36,8 +49,10 @@ void Settings::load_settings()
         settings.value("StartUp/AutoOpenRecent", _open_recent).toBool();
     _sound =
         settings.value("ToolBarPresets/Sound", _sound).toBool();
-    _real_time =
-        settings.value("ToolBarPresets/RealTime", _real_time).toBool();
+    // (speed defaults to the older, on/off "RealTime" setting)
+    _speed = settings.value("ToolBarPresets/RealTime", _speed != 0).toBool();
+    _speed = settings.value("ToolBarPresets/Speed", _speed).toInt();
+    _turbo = settings.value("ToolBarPresets/Turbo", _turbo).toBool();
     _hints =
         settings.value("ToolBarPresets/Hints", _hints).toBool();
     _short_tanks =
@@ -53,6 +68,14 @@ void Settings::load_settings()
         settings.value("Other/DigitalClock", _digital_clock).toBool();
     _initial_orders =
         settings.value("Other/InitialOrders", _initial_orders).toInt();
+    _native_loader =
+        settings.value("Other/NativeLoader", _native_loader).toBool();
+    _load_cache =
+        settings.value("Other/LoadCache", _load_cache).toBool();
+    _intrinsics =
+        settings.value("Other/Intrinsics", _intrinsics).toBool();
+    _jit = settings.value("Other/JIT", _jit).toBool();
+    _fusion = settings.value("Other/Fusion", _fusion).toBool();
     _scale_factor =
         settings.value("EdsacFormScaleFactor/SF", _scale_factor).toInt();
     _edsac_font_size =
@@ -62,6 +85,14 @@ void Settings::load_settings()
         settings.value("Font/FontSize", _edit_font_size).toInt();
     _edit_font_name =
         settings.value("Font/FontName", _edit_font_name).toString();
+    _journal_depth =
+        settings.value("Journal/Depth", _journal_depth).toInt();
+    // (the JIT and fusion work only without an undo journal, so asking
+    // for either turns the journal off; the saved depth is kept for later)
+    if (_jit or _fusion) { _journal_depth = 0; }
+    _journal_interval =
+        settings.value("Journal/Interval", _journal_interval).toInt();
+    if (_journal_interval < 1) { _journal_interval = 1; }
 }
 
 // not currently used -- should we remove it?
@@ -70,7 +101,9 @@ void Settings::save_settings()
     QSettings settings;
     settings.setValue("StartUp/AutoOpenRecent", _open_recent);
     settings.setValue("ToolBarPresets/Sound", _sound);
-    settings.setValue("ToolBarPresets/RealTime", _real_time);
+    settings.setValue("ToolBarPresets/RealTime", _speed != 0);
+    settings.setValue("ToolBarPresets/Speed", _speed);
+    settings.setValue("ToolBarPresets/Turbo", _turbo);
     settings.setValue("ToolBarPresets/Hints", _hints);
     settings.setValue("ToolBarPresets/ShortTanks", _short_tanks);
     settings.setValue("Other/Stop_bell", _stop_bell);
@@ -78,10 +111,19 @@ void Settings::save_settings()
     settings.setValue("Other/Teleprinter", _teleprinter_sound);
     settings.setValue("Other/DigitalClock", _digital_clock);
     settings.setValue("Other/InitialOrders", _initial_orders);
+    settings.setValue("Other/NativeLoader", _native_loader);
+    settings.setValue("Other/LoadCache", _load_cache);
+    settings.setValue("Other/Intrinsics", _intrinsics);
+    settings.setValue("Other/JIT", _jit);
+    settings.setValue("Other/Fusion", _fusion);
     settings.setValue("EdsacFormScaleFactor/SF", _scale_factor);
     settings.setValue("EdsacFormScaleFactor/FontSize", _edsac_font_size);
     settings.setValue("Font/FontSize", _edit_font_size);
     settings.setValue("Font/FontName", _edit_font_name);
+    if (not (_jit or _fusion)) {
+        settings.setValue("Journal/Depth", _journal_depth);
+    }
+    settings.setValue("Journal/Interval", _journal_interval);
 
     settings.sync();    // probably not necessary, but some folks recommend
 }
@@ -15,7 +15,9 @@ public:
     static void save_settings();
 
     static void set_stop_bell(bool value) { _stop_bell = value; }
-    static void set_real_time(bool value) { _real_time = value; }
+    static void set_speed(int value) { _speed = value; }
+    static void set_turbo(bool value) { _turbo = value; }
+    static void set_real_time(bool value) { _speed = value ? 1 : 0; }
     static void set_sound(bool value) { _sound = value; }
     static void set_hints(bool value) { _hints = value; }
     static void set_short_tanks(bool value) { _short_tanks = value; }
@@ -32,6 +34,18 @@ public:
 
     static void set_st_suppress(bool value) { _st_suppress = value; }
 
+    static void set_headless(bool value) { _headless = value; }
+
+    static void set_journal_depth(int value) { _journal_depth = value; }
+    static void set_journal_interval(int value)
+        { _journal_interval = value; }
+
+    static void set_native_loader(bool value) { _native_loader = value; }
+    static void set_load_cache(bool value) { _load_cache = value; }
+    static void set_intrinsics(bool value) { _intrinsics = value; }
+    static void set_jit(bool value) { _jit = value; }
+    static void set_fusion(bool value) { _fusion = value; }
+
     static void set_initial_orders(int value) { _initial_orders = value; }
     static void set_scale_factor(int value) { _scale_factor = value; }
     static void set_edsac_font_size(int value) { _edsac_font_size = value; }
@@ -40,7 +54,12 @@ public:
         { _edit_font_name = value; }
 
     static bool stop_bell() { return _stop_bell; }
-    static bool real_time() { return _real_time; }
+    // multiple of real time to run at (0 = as fast as possible)
+    static int speed() { return _speed; }
+    static bool real_time() { return _speed != 0; }
+
+    // run without per-order display updates (just a progress readout)
+    static bool turbo() { return _turbo; }
     static bool sound() { return _sound; }
     static bool hints() { return _hints; }
     static bool short_tanks() { return _short_tanks; }
@@ -57,6 +76,27 @@ public:
     // for avoiding short tank repainting
     static bool st_suppress() { return _st_suppress; }
 
+    // running from the command line (no windows at all)
+    static bool headless() { return _headless; }
+
+    // # of orders that can be undone (0 = none, as always when the JIT or
+    // fusion is on), and # of orders between full snapshots in the
+    // undo journal
+    static int journal_depth() { return _journal_depth; }
+    static int journal_interval() { return _journal_interval; }
+
+    // load IO2 tapes on the host instead of running the initial orders
+    static bool native_loader() { return _native_loader; }
+    // start unchanged tapes from their saved post-load images
+    static bool load_cache() { return _load_cache; }
+    // run standard library routines (D6, E2, S2, S3, T1) as host code
+    static bool intrinsics() { return _intrinsics; }
+    // run straight-line runs of orders as native (x86-64) code
+    // (only while no undo journal is kept)
+    static bool jit() { return _jit; }
+    // do common pairs of orders as one step (also only without a journal)
+    static bool fusion() { return _fusion; }
+
     static int initial_orders() { return _initial_orders; }
     static int scale_factor() { return _scale_factor; }
     static int edsac_font_size() { return _edsac_font_size; }
@@ -65,7 +105,6 @@ public:
 private:
     static bool
         _stop_bell,
-        _real_time,
         _sound,
         _hints,
         _short_tanks,
@@ -74,8 +113,19 @@ private:
         _teleprinter_sound,
         _digital_clock,
         _literal_output,
-        _st_suppress;
+        _st_suppress,
+        _turbo,
+        _headless,
+        _native_loader,
+        _load_cache,
+        _intrinsics,
+        _jit,
+        _fusion;
     static int _long_tank;
+    static int _speed;
+    static int
+        _journal_depth,
+        _journal_interval;
     static int
         _initial_orders,
         _scale_factor,
@@ -1,18 +1,211 @@
 /*
  * sound.cc -- definitions for audio functions
  */
-#include <QSound>
+#include <QAudioDeviceInfo>
+#include <QAudioFormat>
+#include <QAudioOutput>
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QIODevice>
 #include <QThread>
 
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <mutex>
+#include <vector>
+
 #include "sound.h"
 
 #include "settings.h"
 
-// play a specified sound file, then wait a specified # of ms.
-void play_sound(const QString& name, int delay)
+typedef std::vector<qint16> Samples;    // mono, at the device's rate
+
+static const int OUTPUT_RATE = 48000;   // preferred rate (samples/sec)
+static const int BUFFER_MSECS = 20;     // audio device buffer
+static const unsigned MAX_VOICES = 16;  // sounds playing at once
+
+// Mixes the sounds currently playing into the audio device's stream
+// (QAudioOutput reads it on the audio thread; anything may add to it)
+class Mixer : public QIODevice
+{
+public:
+    Mixer(int nchannels) : channels(nchannels) {}
+
+    // start playing s (dropping the oldest sound if too many are playing)
+    void add(const Samples *s)
+    {   std::lock_guard<std::mutex> guard(lock);
+        if (voices.size() >= MAX_VOICES) { voices.erase(voices.begin()); }
+        voices.push_back(Voice { s, 0 });
+    }
+
+    bool isSequential() const { return true; }
+    qint64 bytesAvailable() const { return INT_MAX; }  // (silence, if idle)
+protected:
+    qint64 readData(char *data, qint64 max_size);
+    qint64 writeData(const char *, qint64) { return -1; }
+private:
+    struct Voice {
+        const Samples *samples;
+        size_t pos;             // next sample to play
+    };
+
+    std::mutex lock;
+    std::vector<Voice> voices;
+    int channels;
+};
+
+// the next max_size bytes of the mixed stream
+qint64 Mixer::readData(char *data, qint64 max_size)
+{
+    qint16 *out = reinterpret_cast<qint16 *>(data);
+    qint64 frames = max_size / qint64(sizeof(qint16) * channels);
+
+    std::lock_guard<std::mutex> guard(lock);
+    for (qint64 i = 0; i < frames; i++) {
+        int sum = 0;
+        for (Voice& v : voices) {
+            if (v.pos < v.samples->size()) { sum += (*v.samples)[v.pos++]; }
+        }
+        qint16 s = std::max(-32768, std::min(32767, sum));
+        for (int c = 0; c < channels; c++) { *out++ = s; }
+    }
+    voices.erase(std::remove_if(voices.begin(), voices.end(),
+        [](const Voice& v) { return v.pos >= v.samples->size(); }),
+        voices.end());
+    return frames * sizeof(qint16) * channels;
+}
+
+static std::map<QString, Samples> sounds;   // (filled before any play)
+static Mixer *mixer = nullptr;
+static QThread *audio_thread = nullptr;
+
+// little-endian integer of n bytes at p
+static unsigned get_le(const char *p, int n)
+{
+    unsigned result = 0;
+    for (int i = n - 1; i >= 0; i--) {
+        result = (result << 8) | uchar(p[i]);
+    }
+    return result;
+}
+
+// decode a PCM WAV file (8- or 16-bit, any channels and rate) into mono
+// samples at the given rate (empty if the file can't be decoded)
+static Samples decode(const QByteArray& wav, int rate)
+{
+    Samples result;
+    if (wav.size() < 12 or not wav.startsWith("RIFF")
+        or wav.mid(8, 4) != "WAVE")
+    {
+        return result;
+    }
+
+    // find the format and data chunks
+    int channels = 0, in_rate = 0, bits = 0;
+    const char *data = nullptr;
+    int data_size = 0;
+    for (int pos = 12; pos + 8 <= wav.size(); ) {
+        QByteArray id = wav.mid(pos, 4);
+        int size = get_le(wav.constData() + pos + 4, 4);
+        const char *body = wav.constData() + pos + 8;
+        size = std::min(size, wav.size() - pos - 8);
+        if (id == "fmt " and size >= 16) {
+            if (get_le(body, 2) != 1) { return result; }    // (not PCM)
+            channels = get_le(body + 2, 2);
+            in_rate = get_le(body + 4, 4);
+            bits = get_le(body + 14, 2);
+        } else if (id == "data") {
+            data = body;
+            data_size = size;
+        }
+        pos += 8 + size + (size & 1);
+    }
+    if (data == nullptr or channels == 0 or in_rate == 0
+        or (bits != 8 and bits != 16))
+    {
+        return result;
+    }
+
+    // mix down to mono, then resample (by linear interpolation)
+    int frame_size = channels * bits / 8;
+    Samples mono(data_size / frame_size);
+    for (size_t i = 0; i < mono.size(); i++) {
+        int sum = 0;
+        for (int c = 0; c < channels; c++) {
+            const char *p = data + i * frame_size + c * bits / 8;
+            sum += (bits == 8) ? (uchar(*p) - 128) << 8
+                               : qint16(get_le(p, 2));
+        }
+        mono[i] = sum / channels;
+    }
+    if (mono.empty()) { return result; }
+    result.resize(mono.size() * qint64(rate) / in_rate);
+    for (size_t i = 0; i < result.size(); i++) {
+        double x = double(i) * in_rate / rate;
+        size_t j = size_t(x);
+        double frac = x - j;
+        qint16 next = (j + 1 < mono.size()) ? mono[j+1] : mono[j];
+        result[i] = qint16(mono[j] + frac * (next - mono[j]));
+    }
+    return result;
+}
+
+// decode every sound into memory and start the audio thread
+// (if there is no usable output device, sounds are quietly skipped)
+void start_sound()
+{
+    QAudioDeviceInfo device = QAudioDeviceInfo::defaultOutputDevice();
+    QAudioFormat format;
+    format.setSampleRate(OUTPUT_RATE);
+    format.setChannelCount(1);
+    format.setSampleSize(16);
+    format.setCodec("audio/pcm");
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setSampleType(QAudioFormat::SignedInt);
+    if (not device.isFormatSupported(format)) {
+        format = device.nearestFormat(format);
+    }
+    if (device.isNull() or format.sampleSize() != 16
+        or format.sampleType() != QAudioFormat::SignedInt
+        or format.byteOrder() != QAudioFormat::LittleEndian)
+    {
+        return;
+    }
+
+    for (const QString& name : QDir(":/").entryList({ "*.wav" })) {
+        QFile f(":/" + name);
+        if (f.open(QIODevice::ReadOnly)) {
+            sounds[":/" + name] = decode(f.readAll(), format.sampleRate());
+        }
+    }
+
+    mixer = new Mixer(format.channelCount());
+    mixer->open(QIODevice::ReadOnly);
+    audio_thread = new QThread();
+    mixer->moveToThread(audio_thread);
+    QObject::connect(audio_thread, &QThread::started, mixer, [format]() {
+        QAudioOutput *output = new QAudioOutput(format, mixer);
+        output->setBufferSize(format.bytesForDuration(BUFFER_MSECS * 1000));
+        output->start(mixer);
+    });
+    audio_thread->start();
+}
+
+// stop the audio thread
+void stop_sound()
+{
+    if (audio_thread == nullptr) { return; }
+    audio_thread->quit();
+    audio_thread->wait();
+}
+
+// start playing a sound (mixed with any already playing); never waits
+void play_sound(const QString& name)
 {
-    if (Settings::sound()) {
-        QSound::play(name);
-        QThread::msleep(delay);
+    if (Settings::sound() and mixer != nullptr) {
+        auto p = sounds.find(name);
+        if (p != sounds.end()) { mixer->add(&p->second); }
     }
 }
@@ -6,6 +6,12 @@
 
 #include <QString>
 
-void play_sound(const QString& name, int delay = 0);
+// decode every sound into memory and start the audio thread (once, at
+// startup), and stop it again (at exit)
+void start_sound();
+void stop_sound();
+
+// start playing a sound (mixed with any already playing); never waits
+void play_sound(const QString& name);
 
 #endif
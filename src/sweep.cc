@@ -0,0 +1,240 @@
+/*
+ * sweep.cc -- definitions for Sweep class
+ *             (one tape run over a range of data values)
+ */
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "sweep.h"
+
+#include "batch.h"
+#include "edsac.h"
+#include "headless.h"
+#include "settings.h"
+
+// a placeholder in the tape
+static const QRegularExpression PLACEHOLDER("\\{(\\w+)\\}");
+
+// a thread that runs the given function
+class Worker : public QThread
+{
+public:
+    Worker(std::function<void()> f) : work(f) {}
+private:
+    void run() override { work(); }
+    std::function<void()> work;
+};
+
+Sweep::Sweep(Edsac *e, const QString& tape)
+    : edsac(e), tape(tape)
+{}
+
+// add the values given for a placeholder ("name=v1,v2,...", where "m..n"
+// stands for the integers m to n)
+bool Sweep::add_values(const QString& spec)
+{
+    static const QRegularExpression RANGE("^(-?\\d+)\\.\\.(-?\\d+)$");
+
+    int eq = spec.indexOf('=');
+    Parameter p;
+    p.name = spec.left(eq);
+    if (eq <= 0 or not tape.contains("{" + p.name + "}")) {
+        fprintf(stderr, "qedsac: bad values %s (no {name} in the tape)\n",
+            qPrintable(spec));
+        return false;
+    }
+    for (const QString& v : spec.mid(eq + 1).split(',')) {
+        QRegularExpressionMatch m = RANGE.match(v);
+        if (not m.hasMatch()) { p.values << v; continue; }
+        long first = m.captured(1).toLong(), last = m.captured(2).toLong();
+        for (long n = first; ; n += (first <= last) ? 1 : -1) {
+            p.values << QString::number(n);
+            if (n == last) { break; }
+        }
+    }
+    params.push_back(p);
+    return true;
+}
+
+// run every variant, a batch at a time on each of the given number of
+// threads, and print the table of their output
+int Sweep::run(bool zip, uint64_t limit, unsigned threads)
+{
+    std::vector<QStringList> values;
+    if (not variants(zip, values)) { return 2; }
+
+    // every variant starts from the initial orders (the tapes are read
+    // in lockstep, for as long as they agree)
+    Settings::set_native_loader(false);
+    Settings::set_load_cache(false);
+    edsac->load_program(QString());
+
+    std::vector<QString> tapes;
+    for (const QStringList& v : values) { tapes.push_back(expand(v)); }
+    std::vector<Result> results(tapes.size());
+    size_t num_batches = (tapes.size() + Batch::LANES - 1) / Batch::LANES;
+    size_t next_batch = 0;
+    uint64_t together = 0, alone = 0;
+    std::mutex lock;
+    auto work = [&]() {
+        for (;;) {
+            size_t b;
+            {   std::lock_guard<std::mutex> guard(lock);
+                b = next_batch++;
+            }
+            if (b >= num_batches) { break; }
+            size_t first = b * Batch::LANES;
+            unsigned n = std::min(tapes.size() - first, size_t(Batch::LANES));
+            Batch batch(edsac, n);
+            for (unsigned i = 0; i < n; i++) {
+                batch.mount_tape(i, tapes[first + i]);
+            }
+            batch.run(limit);
+            for (unsigned i = 0; i < n; i++) {
+                Result& r = results[first + i];
+                r.output = batch.output(i);
+                r.stopped_by = batch.stop_reason(i);
+                r.stopped_at = batch.stopped_at(i);
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            together += batch.lockstep_orders();
+            alone += batch.single_orders();
+        }
+    };
+    threads = std::max(1u, std::min(threads, unsigned(num_batches)));
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (unsigned t = 1; t < threads; t++) {
+        workers.emplace_back(new Worker(work));
+        workers.back()->start();
+    }
+    work();
+    for (auto& w : workers) { w->wait(); }
+
+    print_table(values, results);
+    int status = 0;
+    for (size_t v = 0; v < results.size(); v++) {
+        const Result& r = results[v];
+        if (r.stopped_by != Edsac::HALT_ORDER
+            and r.stopped_by != Edsac::CONDITION
+            and r.stopped_by != Edsac::HUNG)
+        {
+            fprintf(stderr, "qedsac: variant %zu: %s at %u\n", v + 1,
+                Headless::describe(r.stopped_by), r.stopped_at);
+            status = 1;
+        }
+    }
+    fprintf(stderr, "%zu variants on %u thread%s; %llu of %llu orders run"
+            " in lockstep\n", values.size(), threads, threads == 1 ? "" : "s",
+            (unsigned long long)together,
+            (unsigned long long)(together + alone));
+    return status;
+}
+
+// the values of the placeholders for each variant, in the order they
+// were given (false, with a message, if there are none, or a list's
+// columns are of different lengths)
+bool Sweep::variants(bool zip, std::vector<QStringList>& values) const
+{
+    QRegularExpressionMatchIterator it = PLACEHOLDER.globalMatch(tape);
+    while (it.hasNext()) {
+        QString name = it.next().captured(1);
+        auto given = [&name](const Parameter& p) { return p.name == name; };
+        if (std::none_of(params.begin(), params.end(), given)) {
+            fprintf(stderr, "qedsac: no values for {%s}\n", qPrintable(name));
+            return false;
+        }
+    }
+    if (params.empty()) {
+        fprintf(stderr, "qedsac: no values to sweep\n");
+        return false;
+    }
+
+    if (zip) {
+        int n = params[0].values.size();
+        for (const Parameter& p : params) {
+            if (p.values.size() != n) {
+                fprintf(stderr, "qedsac: {%s} has %d values, not %d\n",
+                    qPrintable(p.name), p.values.size(), n);
+                return false;
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            QStringList v;
+            for (const Parameter& p : params) { v << p.values[i]; }
+            values.push_back(v);
+        }
+        return true;
+    }
+
+    // every combination, the last placeholder's values changing fastest
+    values.push_back(QStringList());
+    for (const Parameter& p : params) {
+        std::vector<QStringList> grid;
+        for (const QStringList& v : values) {
+            for (const QString& x : p.values) {
+                grid.push_back(QStringList(v) << x);
+            }
+        }
+        values.swap(grid);
+    }
+    return true;
+}
+
+// the tape with the given values in place of the placeholders
+QString Sweep::expand(const QStringList& values) const
+{
+    QString text = tape;
+    for (size_t i = 0; i < params.size(); i++) {
+        text.replace("{" + params[i].name + "}", values[int(i)]);
+    }
+    return text;
+}
+
+// print the table: a column for each placeholder, then the output (a
+// line at a time, with blank lines at either end left out)
+void Sweep::print_table(const std::vector<QStringList>& values,
+                        const std::vector<Result>& results) const
+{
+    QStringList names;
+    for (const Parameter& p : params) { names << p.name; }
+    std::vector<int> widths;
+    for (int c = 0; c < names.size(); c++) {
+        int w = names[c].size();
+        for (const QStringList& v : values) { w = std::max(w, v[c].size()); }
+        widths.push_back(w);
+    }
+    auto row = [&widths](const QStringList& cells, const QString& text) {
+        QString line;
+        for (int c = 0; c < cells.size(); c++) {
+            line += cells[c].leftJustified(widths[c]) + "  ";
+        }
+        line += text;
+        while (line.endsWith(' ')) { line.chop(1); }
+        fputs(qPrintable(line + '\n'), stdout);
+    };
+
+    QStringList blank;
+    while (blank.size() < names.size()) { blank << QString(); }
+    row(names, "output");
+    for (size_t v = 0; v < values.size(); v++) {
+        QStringList lines = results[v].output.split('\n');
+        while (lines.size() > 1 and lines.front().trimmed().isEmpty()) {
+            lines.removeFirst();
+        }
+        while (lines.size() > 1 and lines.back().trimmed().isEmpty()) {
+            lines.removeLast();
+        }
+        row(values[v], lines[0]);
+        for (int l = 1; l < lines.size(); l++) { row(blank, lines[l]); }
+    }
+    fflush(stdout);
+}
@@ -0,0 +1,59 @@
+/*
+ * sweep.h -- declarations for Sweep class
+ *            (one tape run over a range of data values)
+ */
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <QString>
+#include <QStringList>
+
+#include <cstdint>
+#include <vector>
+
+class Edsac;
+
+// Runs a tape whose text has placeholders, such as {x}, once for each
+// variant: every combination of the values given for the placeholders
+// (a grid), or the first value of each, then the second, and so on (a
+// list).  The variants are run a batch at a time in lockstep (see
+// Batch), with several batches at once on their own threads, each from
+// the initial orders (the native loader can't share one loading between
+// tapes that may differ anywhere).  Their teleprinter output is printed
+// as one table, with a row for each variant.
+class Sweep
+{
+public:
+    Sweep(Edsac *e, const QString& tape);
+
+    // values for a placeholder, given as "name=v1,v2,..." (where a value
+    // "m..n" stands for the integers m to n); false, with a message on
+    // stderr, if the spec is bad
+    bool add_values(const QString& spec);
+
+    // run every variant (a list rather than a grid if zip is set), with
+    // at most limit orders each, and print the table; returns the exit
+    // status
+    int run(bool zip, uint64_t limit, unsigned threads);
+private:
+    struct Parameter {
+        QString name;
+        QStringList values;
+    };
+    struct Result {
+        QString output;
+        int stopped_by;
+        unsigned stopped_at;
+    };
+
+    bool variants(bool zip, std::vector<QStringList>& values) const;
+    QString expand(const QStringList& values) const;
+    void print_table(const std::vector<QStringList>& values,
+                     const std::vector<Result>& results) const;
+
+    Edsac *edsac;
+    QString tape;
+    std::vector<Parameter> params;
+};
+
+#endif
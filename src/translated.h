@@ -0,0 +1,468 @@
+/*
+ * translated.h -- run-time support for programs translated to C++
+ *                 (included by the source files Translator writes)
+ */
+#ifndef TRANSLATED_H
+#define TRANSLATED_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "arith.h"
+#include "attributes.h"
+#include "codes.h"
+
+// A translated program is a function that runs the machine from sequence
+// control onwards, with a case for each order it can reach and a guard
+// on each case that sends it here to step() once the order has been
+// overwritten.  Everything else it needs -- the order functions, the
+// tape reader and teleprinter, and the main program -- is here, and behaves
+// as the simulator does when it runs a tape headless.  None of it needs
+// Qt.
+namespace Translated {
+
+// why the machine stopped (as Edsac::Stop_Reason)
+enum Stop_Reason {
+    NOT_STOPPED, HALT_ORDER, CONDITION, INVALID_ORDER,
+    END_OF_TAPE, BAD_CHARACTER, STOPPED, HUNG
+};
+
+// tape reader results that are not characters (as Tape_Reader's)
+const char ENDFILE = char(-1);
+const char INVALID = char(-2);
+
+// a tape character (by Unicode code point) and its perforator code
+// (-1 for whitespace)
+struct Tape_Char {
+    uint32_t ch;
+    int8_t punch;
+};
+
+struct Machine;
+
+// everything the translator knows about the machine when the program
+// proper starts, and the tables it took from the simulator
+struct Program {
+    const WORD *store;
+    WORD acc[4], mcand[2], mplier[2];
+    ADDR sct, last_loop;
+    WORD order;
+    char last_printed;
+    TICKS time;
+    uint64_t orders;                    // run so far (as headless counts)
+    const char *printed_loading;        // (UTF-8)
+    const char *tape;                   // rest of the tape (UTF-8)
+    int tape_line;                      // ... and the line it starts on
+    const Tape_Char *tape_chars;        // sorted by code point
+    size_t num_tape_chars;
+    const char *const (*printed)[32];   // teleprinter output (UTF-8)
+    const int8_t (*shifts)[32];         // ... and shift after it
+    int shift;                          // shift it is in now
+    const TICKS *timings;               // by function code
+    const uint32_t *unguarded;          // translated orders not checked
+    void (*run)(Machine&);              // the translated program
+};
+
+struct Machine {
+    WORD acc[4], mcand[2], mplier[2];
+    ADDR sct;
+    WORD order;
+    WORD store[STORE_WORDS];
+    TICKS time;
+    uint64_t orders;
+    uint64_t limit = ~uint64_t(0);      // stop when orders reaches this
+    bool skip_loops = true;             // (so detect idle loops)
+    bool running = true;
+    Stop_Reason stopped_by = NOT_STOPPED;
+    char last_printed;
+    ADDR last_loop;
+    std::vector<char> tape;             // punch codes, then ENDFILE/INVALID
+    size_t tape_pos = 0;
+    uint32_t bad_char = 0;              // the INVALID one, if any
+    int bad_line = 0;                   // ... and its line
+    int shift = 0;                      // teleprinter letter/figure shift
+    bool interpret_all = false;         // (an unguarded order overwritten)
+    const Program *program;
+};
+
+using Codes::code_of;       // punch code for given letter
+
+inline WORD get_word(const Machine& m, ADDR a)
+    { return m.store[a % STORE_WORDS]; }
+inline void store_word(Machine& m, ADDR a, WORD value)
+    { m.store[a % STORE_WORDS] = value; }
+
+// true if the accumulator is >= 0
+inline bool positive(const Machine& m)
+    { return (m.acc[3] & SIGN_BIT) == 0; }
+
+// stop the machine
+inline void stop(Machine& m, Stop_Reason why)
+{
+    m.running = false;
+    m.stopped_by = why;
+}
+
+// count an order that took t ticks; if that reaches the order limit
+// (and the machine is still running), stop with sequence control at
+// next (false if so)
+inline bool count(Machine& m, TICKS t, ADDR next)
+{
+    m.time += t;
+    if (++m.orders != m.limit or not m.running) { return true; }
+    m.sct = next;
+    stop(m, CONDITION);
+    return false;
+}
+
+//---------- order functions (as Edsac's) ----------
+inline void load_mcand(Machine& m, ADDR a, bool lflag)
+{
+    a &= ~ADDR(lflag);
+    m.mcand[0] = lflag ? get_word(m, a++) : 0;
+    m.mcand[1] = get_word(m, a);
+}
+
+inline void add(Machine& m, ADDR a, bool lflag)
+{
+    load_mcand(m, a, lflag);
+    add_number(m.acc, m.mcand[0], m.mcand[1]);
+}
+
+inline void subtract(Machine& m, ADDR a, bool lflag)
+{
+    load_mcand(m, a, lflag);
+    subtract_number(m.acc, m.mcand[0], m.mcand[1]);
+}
+
+inline void load_multiplier(Machine& m, ADDR a, bool lflag)
+{
+    a &= ~ADDR(lflag);
+    m.mplier[0] = lflag ? get_word(m, a++) : 0;
+    m.mplier[1] = get_word(m, a);
+}
+
+inline void mult(Machine& m, ADDR a, bool lflag, bool subtract)
+{
+    load_mcand(m, a, lflag);
+    multiply(m.acc, m.mcand, m.mplier, subtract);
+    m.mcand[0] = m.mcand[1] = 0;
+}
+
+inline void u_transfer(Machine& m, ADDR a, bool lflag)
+{
+    a &= ~ADDR(lflag);
+    if (lflag) { store_word(m, a++, m.acc[2]); }
+    store_word(m, a, m.acc[3]);
+}
+
+inline void transfer(Machine& m, ADDR a, bool lflag)
+{
+    u_transfer(m, a, lflag);
+    m.acc[0] = m.acc[1] = m.acc[2] = m.acc[3] = 0;
+}
+
+inline void collate(Machine& m, ADDR a, bool lflag)
+{
+    load_mcand(m, a, lflag);
+    add_number(m.acc, m.mcand[0] & m.mplier[0], m.mcand[1] & m.mplier[1]);
+}
+
+inline void rshift(Machine& m, int nbits)
+{
+    for (int i = 0; i < nbits; i++) { shift_right(m.acc, 4); }
+}
+
+inline void lshift(Machine& m, int nbits)
+{
+    for (int i = 0; i < nbits; i++) { shift_left(m.acc, 4); }
+}
+
+// report the end of the tape or an invalid character on it (as the tape
+// reader does, headless)
+inline void tape_error(const Machine& m, char ch)
+{
+    if (ch == ENDFILE) {
+        fputs("Error: End of input tape encountered\n", stderr);
+        return;
+    }
+    // (Qt reports a character beyond 16 bits by its first half)
+    uint32_t c = m.bad_char;
+    if (c > 0xFFFF) { c = 0xD800 + ((c - 0x10000) >> 10); }
+    char utf8[4] = { '?', '\0' };
+    if (c >= 0x800 and (c < 0xD800 or c > 0xDFFF)) {
+        utf8[0] = 0xE0 | (c >> 12);
+        utf8[1] = 0x80 | ((c >> 6) & 0x3F);
+        utf8[2] = 0x80 | (c & 0x3F);
+    } else if (c >= 0x80 and c < 0x800) {
+        utf8[0] = 0xC0 | (c >> 6);
+        utf8[1] = 0x80 | (c & 0x3F);
+    } else if (c < 0x80) {
+        utf8[0] = c;
+    }
+    fprintf(stderr, "Error: Illegal character on line number %d\n"
+            "['%s' Unicode value U+%04X]\n", m.bad_line, utf8, unsigned(c));
+}
+
+// (false if the machine stopped at the end of the tape or a bad character)
+inline bool read(Machine& m, ADDR a, bool lflag)
+{
+    a &= ~ADDR(lflag);
+    if (lflag) { store_word(m, a++, 0); }
+    char ch = m.tape[m.tape_pos];
+    if (ch == ENDFILE or ch == INVALID) {
+        stop(m, ch == ENDFILE ? END_OF_TAPE : BAD_CHARACTER);
+        tape_error(m, ch);
+        return false;
+    }
+    ++m.tape_pos;
+    store_word(m, a, ch);
+    return true;
+}
+
+inline void print(Machine& m, ADDR a, bool lflag)
+{
+    if ((a & 0x1) == 0) { a += lflag; }
+    char c = (get_word(m, a) >> (HIWORD_BITS - CHAR_BITS)) & MAX_CHAR;
+    fputs(m.program->printed[m.shift][int(c)], stdout);
+    m.shift = m.program->shifts[m.shift][int(c)];
+    m.last_printed = c;
+}
+
+inline void print_check(Machine& m, ADDR a, bool lflag)
+{
+    a &= ~ADDR(lflag);
+    if (lflag) { store_word(m, a++, 0); }
+    store_word(m, a, m.last_printed << (ADDR_BITS + FLAG_BITS));
+}
+//---------- end of order functions ----------
+
+// true if the loop from top to the branch at "at" is an idle loop that
+// can never end (A and S orders only, adding up to nothing), once the
+// machine has been round it before
+inline bool idle_loop(Machine& m, ADDR top, ADDR at)
+{
+    bool again = (m.last_loop == at);
+    m.last_loop = at;
+    if (not m.skip_loops or not again) { return false; }
+    LONGWORD delta;
+    auto word = [&m](ADDR a) { return get_word(m, a); };
+    return loop_delta(top, at, word, delta) and delta == 0;
+}
+
+// fetch & execute the order at sequence control by interpreting it
+// (for the orders the translation could not foresee)
+inline void step(Machine& m)
+{
+    ADDR at = m.sct;
+    WORD w = get_word(m, at);
+    m.sct = (at + 1) & MAX_ADDR;
+    m.order = w;
+    bool lflag = (w & MAX_FLAG) != 0;
+    ADDR a = (w >> FLAG_BITS) & MAX_ADDR;
+    int func = w >> (ADDR_BITS + FLAG_BITS);
+
+    switch (func) {
+        case code_of('A'):  add(m, a, lflag); break;
+        case code_of('S'):  subtract(m, a, lflag); break;
+        case code_of('H'):  load_multiplier(m, a, lflag); break;
+        case code_of('V'):  mult(m, a, lflag, false); break;
+        case code_of('N'):  mult(m, a, lflag, true); break;
+        case code_of('T'):  transfer(m, a, lflag); break;
+        case code_of('U'):  u_transfer(m, a, lflag); break;
+        case code_of('C'):  collate(m, a, lflag); break;
+        case code_of('R'):  rshift(m, shift_length(w)); break;
+        case code_of('L'):  lshift(m, shift_length(w)); break;
+        case code_of('E'):  if (positive(m)) { m.sct = a; } break;
+        case code_of('G'):  if (not positive(m)) { m.sct = a; } break;
+        case code_of('I'):  if (not read(m, a, lflag)) { m.sct = at; } break;
+        case code_of('O'):  print(m, a, lflag); break;
+        case code_of('F'):  print_check(m, a, lflag); break;
+        case code_of('X'):  break;
+        case code_of('Y'):  round_off(m.acc); break;
+        case code_of('Z'):  stop(m, HALT_ORDER); break;
+        default:            stop(m, INVALID_ORDER); break;
+    }
+    if (m.running and m.sct <= at
+        and (func == code_of('E') or func == code_of('G')))
+    {
+        if (m.sct == at or idle_loop(m, m.sct, at)) { stop(m, HUNG); }
+    }
+    if (func == code_of('T') or func == code_of('U')
+        or func == code_of('I') or func == code_of('F'))
+    {
+        // overwriting an order translated without a guard means the
+        // translation can no longer be trusted
+        const Program& p = *m.program;
+        a &= ~ADDR(lflag);
+        for (ADDR n = a; n <= a + lflag; n++) {
+            ADDR i = n % STORE_WORDS;
+            if ((p.unguarded[i / 32] >> (i % 32) & 1) != 0
+                and m.store[i] != p.store[i])
+            {
+                m.interpret_all = true;
+            }
+        }
+    }
+    count(m, m.program->timings[func], m.sct);
+}
+
+// interpret the order at sequence control (one the translation can't run),
+// and everything after it if the translation can no longer be trusted;
+// false once the machine stops
+inline bool interpret(Machine& m)
+{
+    step(m);
+    while (m.interpret_all and m.running) { step(m); }
+    return m.running;
+}
+
+// punch the tape for UTF-8 text, as the tape reader reads it (whitespace
+// and [comments] skipped; ENDFILE or INVALID at the end), noting where
+// an invalid character is (the text starting on the given line)
+inline void punch_tape(Machine& m, const char *text, int line)
+{
+    const Program& p = *m.program;
+    const unsigned char *s = reinterpret_cast<const unsigned char *>(text);
+    if (strncmp(text, "\xEF\xBB\xBF", 3) == 0) { s += 3; }    // (BOM)
+    bool comment = false;
+    while (*s != '\0') {
+        uint32_t ch = *s++;
+        int extra = (ch >= 0xF0) ? 3 : (ch >= 0xE0) ? 2 : (ch >= 0xC0);
+        if (ch >= 0x80 and ch < 0xC0) { ch = 0xFFFD; }  // (not UTF-8)
+        else if (extra > 0) { ch &= 0x3F >> extra; }
+        for (; extra > 0 and (*s & 0xC0) == 0x80; extra--) {
+            ch = (ch << 6) | (*s++ & 0x3F);
+        }
+        if (extra > 0) { ch = 0xFFFD; }
+
+        if (ch == '\n') { ++line; }
+        if (comment) { comment = (ch != ']'); continue; }
+        if (ch == '[') { comment = true; continue; }
+        size_t lo = 0, hi = p.num_tape_chars;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (p.tape_chars[mid].ch < ch) { lo = mid + 1; }
+            else { hi = mid; }
+        }
+        if (lo == p.num_tape_chars or p.tape_chars[lo].ch != ch) {
+            m.tape.push_back(INVALID);
+            m.bad_char = ch;
+            m.bad_line = line;
+            return;
+        }
+        if (p.tape_chars[lo].punch >= 0) {
+            m.tape.push_back(p.tape_chars[lo].punch);
+        }
+    }
+    m.tape.push_back(ENDFILE);
+}
+
+// describe why the machine stopped (as a headless run does)
+inline const char *describe(Stop_Reason why)
+{
+    switch (why) {
+        case NOT_STOPPED:   return "still running";
+        case HALT_ORDER:    return "stopped by Z order";
+        case CONDITION:     return "run-until condition met";
+        case INVALID_ORDER: return "invalid order";
+        case END_OF_TAPE:   return "end of input tape";
+        case BAD_CHARACTER: return "invalid input character";
+        case STOPPED:       return "stopped";
+        case HUNG:          return "hung in a loop";
+    }
+    return "unknown";
+}
+
+// run the translated program as "qedsac --headless" runs the tape:
+//     program [--orders n] [--dial digits] [data-tape]
+// (a data tape is read in place of the rest of the original tape)
+// returns the exit status
+inline int run_program(int argc, char *argv[], const Program& p)
+{
+    static Machine m;       // (big)
+    const char *data = nullptr;
+    std::deque<unsigned> dial;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--orders" and i + 1 < argc) {
+            m.limit = strtoull(argv[++i], nullptr, 10);
+            m.skip_loops = false;
+        } else if (arg == "--dial" and i + 1 < argc) {
+            for (const char *d = argv[++i]; *d != '\0'; d++) {
+                if (*d >= '0' and *d <= '9') {
+                    dial.push_back(*d == '0' ? 10 : *d - '0');
+                }
+            }
+        } else if (data == nullptr and arg[0] != '-') {
+            data = argv[i];
+        } else {
+            fprintf(stderr, "usage: %s [--orders n] [--dial digits]"
+                    " [data-tape]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::string text = p.tape;
+    if (data != nullptr) {
+        FILE *f = fopen(data, "rb");
+        if (f == nullptr) {
+            fprintf(stderr, "%s: unable to open %s\n", argv[0], data);
+            return 2;
+        }
+        text.clear();
+        char buffer[4096];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof buffer, f)) > 0) {
+            text.append(buffer, n);
+        }
+        fclose(f);
+    }
+
+    std::copy(p.store, p.store + STORE_WORDS, m.store);
+    std::copy(p.acc, p.acc + 4, m.acc);
+    std::copy(p.mcand, p.mcand + 2, m.mcand);
+    std::copy(p.mplier, p.mplier + 2, m.mplier);
+    m.sct = p.sct;
+    m.order = p.order;
+    m.last_loop = p.last_loop;
+    m.last_printed = p.last_printed;
+    m.shift = p.shift;
+    m.time = p.time;
+    m.orders = p.orders;
+    m.program = &p;
+    punch_tape(m, text.c_str(), data == nullptr ? p.tape_line : 1);
+    fputs(p.printed_loading, stdout);
+
+    if (m.orders < m.limit) {
+        for (;;) {
+            if (m.interpret_all) { interpret(m); }
+            else { p.run(m); }
+            if (m.stopped_by != HALT_ORDER or dial.empty()) { break; }
+            m.acc[3] = (m.acc[3] + 2 * dial.front()) & MAX_HIWORD;
+            dial.pop_front();
+            m.running = true;
+            m.stopped_by = NOT_STOPPED;
+        }
+    }
+    fflush(stdout);
+
+    fprintf(stderr, "\n%llu orders executed; %s at %u\n",
+            (unsigned long long)m.orders, describe(m.stopped_by),
+            unsigned(m.sct));
+    fprintf(stderr, "simulated time %llu.%04llu seconds\n",
+            (unsigned long long)(m.time / 10000),
+            (unsigned long long)(m.time % 10000));
+    return (m.stopped_by == HALT_ORDER or m.stopped_by == CONDITION
+            or m.stopped_by == HUNG) ? 0 : 1;
+}
+
+}
+
+#endif
@@ -0,0 +1,438 @@
+/*
+ * translator.cc -- definitions for Translator class
+ *                  (loaded programs translated to C++)
+ */
+#include <QByteArray>
+#include <QFile>
+#include <QFileInfo>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+#include <cstdio>
+
+#include "translator.h"
+
+#include "arith.h"
+#include "attributes.h"
+#include "codes.h"
+#include "edsac.h"
+#include "input.h"
+#include "output.h"
+#include "postmortem.h"
+#include "tank.h"
+
+using Codes::code_of;       // punch code for given letter
+
+static const unsigned SCT_VALUES = MAX_ADDR + 1;
+
+// the C++ literal for a string of bytes (a line of source per line of text)
+static QString literal(const QByteArray& bytes)
+{
+    QString result = "\"";
+    for (int i = 0; i < bytes.size(); i++) {
+        unsigned char c = bytes[i];
+        if (c == '\n') {
+            result += "\\n";
+            if (i + 1 < bytes.size()) { result += "\"\n    \""; }
+        } else if (c == '"' or c == '\\' or c == '?') {
+            result += QString("\\") + QChar(c);
+        } else if (c < ' ' or c >= 0x7F) {      // (always three digits)
+            result += QString("\\%1").arg(c, 3, 8, QChar('0'));
+        } else {
+            result += QChar(c);
+        }
+    }
+    return result + "\"";
+}
+
+Translator::Translator(Edsac *e)
+    : edsac(e), reachable(SCT_VALUES), labelled(SCT_VALUES),
+      written(STORE_WORDS)
+{}
+
+// run the mounted tape until loading ends, then write the translation
+// of the program to file_name (false if that can't be done)
+bool Translator::write(const QString& file_name, const QString& tape_name)
+{
+    // run the loading (order by order, so as to stop exactly where it
+    // ends), keeping what is printed meanwhile for the runner to print
+    edsac->interpret_only = true;
+    uint64_t n = loading_orders();
+    auto hook = edsac->print_hook;
+    Teleprinter::Shift_Mode mode = Teleprinter::LETTERS;
+    edsac->print_hook = [this, &mode](char c) {
+        QChar qc = Teleprinter::translate(c, mode);
+        if (qc == 'n') { printed_loading += '\n'; }
+        else if (not qc.isLower()) {
+            printed_loading += QString(qc).toLocal8Bit();
+        }
+    };
+    edsac->run_orders(n);
+    edsac->print_hook = hook;
+    edsac->interpret_only = false;
+    shift = mode;
+    if (edsac->stopped_by != Edsac::NOT_STOPPED
+        and edsac->stopped_by != Edsac::CONDITION)
+    {
+        fprintf(stderr, "qedsac: the machine stopped while loading\n");
+        return false;
+    }
+
+    image = edsac->store_image();
+    ADDR sct = edsac->sct[0];
+    find_reachable(sct);
+
+    QFile f(file_name);
+    if (not f.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        fprintf(stderr, "qedsac: unable to write %s\n", qPrintable(file_name));
+        return false;
+    }
+
+    QString base = QFileInfo(file_name).fileName();
+    QString out;
+    out += "/*\n * " + base + " -- " + QFileInfo(tape_name).fileName()
+        + " translated to C++ by qedsac\n"
+        + " *" + QString(base.size() + 4, ' ')
+        + "(build with: c++ -O2 -I<qedsac source dir> " + base + ")\n */\n";
+    out += "#include \"translated.h\"\n\nusing namespace Translated;\n\n";
+    out += tables();
+
+    // the program
+    unsigned num_orders = 0;
+    out += "// the program, from sequence control until the machine stops\n"
+           "static void run(Machine& m)\n{\n"
+           "    for (;;) {\n        switch (m.sct) {\n";
+    for (unsigned a = 0; a < SCT_VALUES; a++) {
+        if (reachable[a]) {
+            out += translate(a);
+            ++num_orders;
+        }
+    }
+    out += "        }\n        if (not interpret(m)) { return; }\n"
+           "    }\n}\n\n";
+
+    // the machine as it is now
+    const Tank *regs[] = { &edsac->acc, &edsac->mcand, &edsac->mplier };
+    QStringList words;
+    for (const Tank *t : regs) {
+        QStringList w;
+        for (WORD *p = t->begin(); p != t->end(); p++) {
+            w << QString::number(*p);
+        }
+        words << "{ " + w.join(", ") + " }";
+    }
+    out += "static const Program PROGRAM = {\n    STORE, "
+        + words.join(", ") + ",\n"
+        + QString("    %1, %2, %3, %4, %5, %6,\n")
+            .arg(sct).arg(edsac->last_loop).arg(edsac->order[0])
+            .arg(int(edsac->last_printed))
+            .arg(edsac->sim_time).arg(edsac->order_count)
+        + QString("    PRINTED_LOADING, TAPE, %1,\n")
+            .arg(edsac->input->line())
+        + "    TAPE_CHARS, sizeof TAPE_CHARS / sizeof TAPE_CHARS[0],\n"
+        + QString("    PRINTED, SHIFTS, %1, TIMINGS, UNGUARDED, run\n};\n\n")
+            .arg(shift);
+    out += "int main(int argc, char *argv[])\n{\n"
+           "    return run_program(argc, argv, PROGRAM);\n}\n";
+
+    f.write(out.toUtf8());
+    if (not f.flush()) {
+        fprintf(stderr, "qedsac: unable to write %s\n", qPrintable(file_name));
+        return false;
+    }
+    fprintf(stderr, "%u orders from %u translated to %s\n", num_orders,
+            unsigned(sct), qPrintable(file_name));
+    return true;
+}
+
+// the number of orders loading takes: the tape is run until it stops
+// (or for at most MAX_TRIAL orders), and loading ends the last time
+// sequence control left the initial orders (the tape is then mounted
+// afresh, and the machine put back as it was)
+uint64_t Translator::loading_orders()
+{
+    static const uint64_t MAX_TRIAL = 10000000;
+
+    const TICKS time = edsac->sim_time;
+    const uint64_t start = edsac->order_count;
+    const char last_printed = edsac->last_printed;
+    const ADDR last_loop = edsac->last_loop;
+    const QString tape = edsac->input->text();
+
+    const ADDR end = edsac->initial_orders_end;
+    bool loader = edsac->sct[0] < end;
+    uint64_t last_exit = start;
+    auto hook = edsac->print_hook;
+    edsac->print_hook = nullptr;
+    QtMessageHandler handler = qInstallMessageHandler(    // (say nothing)
+        [](QtMsgType, const QMessageLogContext&, const QString&) {});
+    edsac->run_until([&]() {
+        ADDR at = edsac->sct[0];
+        if (loader and at >= end) { last_exit = edsac->order_count; }
+        loader = (at < end);
+        return edsac->order_count - start >= MAX_TRIAL;
+    });
+    qInstallMessageHandler(handler);
+    edsac->print_hook = hook;
+
+    edsac->load_program(tape);
+    edsac->sim_time = time;
+    edsac->order_count = start;
+    edsac->last_printed = last_printed;
+    edsac->last_loop = last_loop;
+    return last_exit - start;
+}
+
+// mark everything sequence control can reach from start (taking each
+// branch both ways, and carrying on after each Z order, since the machine
+// can be restarted there)
+void Translator::find_reachable(ADDR start)
+{
+    static const char E = code_of('E'), G = code_of('G');
+    static const char *const VALID = "ASHVNTUCRLEGIOFXYZ";
+
+    std::vector<ADDR> to_do = { start };
+    reachable[start] = true;
+    auto reach = [this, &to_do](ADDR a) {
+        if (not reachable[a]) { reachable[a] = true; to_do.push_back(a); }
+    };
+    while (not to_do.empty()) {
+        ADDR at = to_do.back();
+        to_do.pop_back();
+        WORD w = image[at % STORE_WORDS];
+        char func = w >> (ADDR_BITS + FLAG_BITS);
+        ADDR a = (w >> FLAG_BITS) & MAX_ADDR;
+        ADDR next = (at + 1) & MAX_ADDR;
+        bool valid = false;
+        for (const char *v = VALID; *v != '\0'; v++) {
+            if (code_of(*v) == func) { valid = true; }
+        }
+        if (func == E or func == G) {
+            labelled[a] = true;
+            reach(a);
+        }
+        if (valid) {
+            reach(next);
+            if (next == 0) { labelled[next] = true; }   // (no fall through)
+        }
+    }
+
+    // the words the translated orders themselves can write: only orders
+    // there need guards, since step() notes when it overwrites any other
+    for (unsigned at = 0; at < SCT_VALUES; at++) {
+        WORD w = image[at % STORE_WORDS];
+        char func = w >> (ADDR_BITS + FLAG_BITS);
+        if (reachable[at]
+            and (func == code_of('T') or func == code_of('U')
+                 or func == code_of('I') or func == code_of('F')))
+        {
+            bool lflag = (w & MAX_FLAG) != 0;
+            ADDR a = (w >> FLAG_BITS) & MAX_ADDR & ~ADDR(lflag);
+            written[a % STORE_WORDS] = true;
+            if (lflag) { written[(a + 1) % STORE_WORDS] = true; }
+        }
+    }
+}
+
+// the case for the order at sequence control value "at"
+QString Translator::translate(ADDR at) const
+{
+    static const char *const CALLS[] = {
+        nullptr,            // P
+        nullptr,            // Q
+        nullptr,            // W
+        nullptr,            // E
+        nullptr,            // R
+        "transfer",         // T
+        nullptr,            // Y
+        "u_transfer",       // U
+        nullptr,            // I
+        "print",            // O
+        nullptr,            // J
+        nullptr,            // pi
+        "subtract",         // S
+        nullptr,            // Z
+        nullptr,            // K
+        nullptr,            // erase
+        nullptr,            // blank
+        "print_check",      // F
+        nullptr,            // theta
+        nullptr,            // D
+        nullptr,            // phi
+        "load_multiplier",  // H
+        nullptr,            // N
+        nullptr,            // M
+        nullptr,            // delta
+        nullptr,            // L
+        nullptr,            // X
+        nullptr,            // G
+        "add",              // A
+        nullptr,            // B
+        "collate",          // C
+        nullptr             // V
+    };
+    const QString IN = "            ";      // (indentation)
+
+    WORD w = image[at % STORE_WORDS];
+    char func = w >> (ADDR_BITS + FLAG_BITS);
+    ADDR a = (w >> FLAG_BITS) & MAX_ADDR;
+    bool lflag = (w & MAX_FLAG) != 0;
+    ADDR next = (at + 1) & MAX_ADDR;
+    TICKS ticks = Edsac::timings[int(func)];
+    QString args = QString("m, %1, %2").arg(a).arg(lflag ? "true" : "false");
+
+    // stop with sequence control at sct (counting the order)
+    auto stop = [ticks](const QString& in, const QString& why, ADDR sct) {
+        return in + QString("stop(m, %1); m.sct = %2; count(m, %3, %2);"
+                            " return;\n").arg(why).arg(sct).arg(ticks);
+    };
+    // count the order, and carry on at sct (jumping there unless it is
+    // the next case, which is marked as meant for -Wimplicit-fallthrough)
+    auto carry_on = [ticks](const QString& in, ADDR sct, bool jump) {
+        QString s = in + QString("if (not count(m, %1, %2)) { return; }\n")
+                            .arg(ticks).arg(sct);
+        if (jump) { s += in + QString("goto a%1;\n").arg(sct); }
+        else { s += in + "// fall through\n"; }
+        return s;
+    };
+
+    QString s = QString("        case %1:").arg(at);
+    if (labelled[at]) { s += QString(" a%1:").arg(at); }
+    s = s.leftJustified(24) + QString("// %1\n").arg(Post_Mortem::order(w));
+    if (written[at % STORE_WORDS]) {
+        s += IN + QString("if (m.store[%1] != %2) { m.sct = %3; break; }\n")
+                    .arg(at % STORE_WORDS).arg(w).arg(at);
+    }
+
+    if (CALLS[int(func)] != nullptr) {
+        s += IN + QString("%1(%2);\n").arg(CALLS[int(func)]).arg(args);
+    } else if (func == code_of('V') or func == code_of('N')) {
+        s += IN + QString("mult(%1, %2);\n")
+                    .arg(args).arg(func == code_of('N') ? "true" : "false");
+    } else if (func == code_of('R') or func == code_of('L')) {
+        s += IN + QString("%1(m, %2);\n")
+                    .arg(func == code_of('R') ? "rshift" : "lshift")
+                    .arg(shift_length(w));
+    } else if (func == code_of('Y')) {
+        s += IN + "round_off(m.acc);\n";
+    } else if (func == code_of('I')) {
+        s += IN + QString("if (not read(%1)) {\n").arg(args)
+           + IN + QString("    m.sct = %1; count(m, %2, %1); return;\n")
+                    .arg(at).arg(ticks)
+           + IN + "}\n";
+    } else if (func == code_of('Z')) {
+        return s + stop(IN, "HALT_ORDER", next);
+    } else if (func == code_of('E') or func == code_of('G')) {
+        // taken: a jump to itself hangs; a jump back may close an idle
+        // loop, and is noted for spotting one (see loop_delta)
+        s += IN + QString(func == code_of('E') ? "if (positive(m)) {\n"
+                                            : "if (not positive(m)) {\n");
+        if (a == at) {
+            s += stop(IN + "    ", "HUNG", a);
+        } else {
+            if (a < at and idle_loop(a, at)) {
+                s += IN + QString("    if (idle_loop(m, %1, %2)) {\n")
+                            .arg(a).arg(at)
+                   + stop(IN + "        ", "HUNG", a)
+                   + IN + "    }\n";
+            } else if (a < at) {
+                s += IN + QString("    m.last_loop = %1;\n").arg(at);
+            }
+            s += carry_on(IN + "    ", a, true);
+        }
+        s += IN + "}\n";
+        if (next == 0) { s += IN + QString("m.last_loop = %1;\n").arg(at); }
+    } else if (func != code_of('X')) {
+        return s + stop(IN, "INVALID_ORDER", next);
+    }
+    return s + carry_on(IN, next, next == 0);
+}
+
+// true if the orders from top up to the branch at "at" are the A and S
+// orders of a loop short enough for the simulator to check for one that
+// changes nothing
+bool Translator::idle_loop(ADDR top, ADDR at) const
+{
+    LONGWORD delta;
+    auto word = [this](ADDR a) { return image[a % STORE_WORDS]; };
+    return loop_delta(top, at, word, delta);
+}
+
+// the store image, the rest of the tape, and the tables taken from the
+// simulator (what the tape reader reads and the teleprinter prints)
+QString Translator::tables() const
+{
+    QString s = "// the store when the program proper starts\n"
+                "static const WORD STORE[STORE_WORDS] = {";
+    for (unsigned a = 0; a < STORE_WORDS; a++) {
+        if (a % 8 == 0) { s += "\n   "; }
+        s += QString(" %1,").arg(image[a], 6);
+    }
+    s += "\n};\n\n";
+
+    s += "// printed while the tape was loading\n"
+         "static const char PRINTED_LOADING[] =\n    "
+        + literal(printed_loading) + ";\n\n";
+    const Tape_Reader *input = edsac->input;
+    s += "// the rest of the tape\nstatic const char TAPE[] =\n    "
+        + literal(input->text().mid(input->position()).toUtf8()) + ";\n\n";
+
+    s += "// tape characters (and whitespace) by Unicode code point\n"
+         "static const Tape_Char TAPE_CHARS[] = {";
+    int n = 0;
+    for (unsigned u = 0; u <= 0xFFFF; u++) {
+        QChar ch(u);
+        int punch = ch.isSpace() ? -1 : Tape_Reader::punch(ch);
+        if (punch == -1 and not ch.isSpace()) { continue; }
+        if (n++ % 6 == 0) { s += "\n   "; }
+        s += QString(" { %1, %2 },").arg(u, 5).arg(punch, 2);
+    }
+    s += "\n};\n\n";
+
+    QString printed, shifts;
+    for (int m = Teleprinter::LETTERS; m <= Teleprinter::FIGURES; m++) {
+        printed += "    {";
+        shifts += "    {";
+        for (WORD c = 0; c <= MAX_CHAR; c++) {
+            Teleprinter::Shift_Mode mode = Teleprinter::Shift_Mode(m);
+            QChar qc = Teleprinter::translate(char(c), mode);
+            if (c % 8 == 0) { printed += "\n       "; }
+            printed += " " + literal(qc == 'n' ? QByteArray("\n")
+                                     : qc.isLower() ? QByteArray()
+                                     : QString(qc).toLocal8Bit()) + ",";
+            shifts += QString(" %1,").arg(mode);
+        }
+        printed += "\n    },\n";
+        shifts += " },\n";
+    }
+    s += "// what the teleprinter prints (as a headless run shows it), and\n"
+         "// the shift it is left in, by shift and character\n"
+         "static const char *const PRINTED[2][32] = {\n" + printed + "};\n"
+         "static const int8_t SHIFTS[2][32] = {\n" + shifts + "};\n\n";
+
+    s += "// time taken by each order (10 ticks == 1 millisecond)\n"
+         "static const TICKS TIMINGS[32] = {";
+    for (WORD f = 0; f <= MAX_FUNC; f++) {
+        if (f % 8 == 0) { s += "\n   "; }
+        s += QString(" %1,").arg(Edsac::timings[f], 4);
+    }
+    s += "\n};\n\n";
+
+    s += "// translated orders with no guard, a bit per word\n"
+         "static const uint32_t UNGUARDED[STORE_WORDS / 32] = {";
+    for (unsigned i = 0; i < STORE_WORDS / 32; i++) {
+        uint32_t bits = 0;
+        for (unsigned b = 0; b < 32; b++) {
+            unsigned a = 32 * i + b;
+            if ((reachable[a] or reachable[a + STORE_WORDS])
+                and not written[a])
+            {
+                bits |= uint32_t(1) << b;
+            }
+        }
+        if (i % 6 == 0) { s += "\n   "; }
+        s += QString(" 0x%1,").arg(bits, 8, 16, QChar('0'));
+    }
+    return s + "\n};\n\n";
+}
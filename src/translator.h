@@ -0,0 +1,55 @@
+/*
+ * translator.h -- declarations for Translator class
+ *                 (loaded programs translated to C++)
+ */
+#ifndef TRANSLATOR_H
+#define TRANSLATOR_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <vector>
+
+#include "attributes.h"
+
+class Edsac;
+
+// Writes the program in the store, once it has been loaded, as a C++
+// source file that runs it natively: a function with a case for each
+// order that sequence control can reach from where the program starts
+// (following every branch both ways).  Orders in words that translated
+// orders can write are guarded by a check that they are still the ones
+// translated; an order that has been overwritten (or one at an address the
+// translation never reached, such as a planted return link's target) is
+// interpreted by translated.h's step(), with the same arithmetic helpers
+// (arith.h) the simulator uses.  Should step() overwrite an unguarded
+// order, the runner interprets everything from then on.  The file also
+// carries the store image and registers, the rest of the tape, and the
+// tape reader's and teleprinter's tables, so the runner it compiles to
+// prints exactly what "qedsac --headless" prints for the same tape.
+class Translator
+{
+public:
+    Translator(Edsac *e);
+
+    // run the mounted tape until loading ends, then write the
+    // translation (of the program on the named tape) to file_name;
+    // false, with a message on stderr, if that can't be done
+    bool write(const QString& file_name, const QString& tape_name);
+private:
+    uint64_t loading_orders();
+    void find_reachable(ADDR start);
+    QString translate(ADDR at) const;
+    QString tables() const;
+    bool idle_loop(ADDR top, ADDR at) const;
+
+    Edsac *edsac;
+    std::vector<WORD> image;            // the store
+    std::vector<bool> reachable;        // by sequence control value
+    std::vector<bool> labelled;         // ... and jumped to
+    std::vector<bool> written;          // by translated orders
+    QByteArray printed_loading;         // before the program proper
+    int shift = 0;                      // teleprinter shift after that
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include "tube.h"
 
 #include "attributes.h"
+#include "decimal.h"
 #include "display.h"
 #include "edsac.h"
 #include "layout.h"
@@ -40,10 +41,8 @@ void Display_Tube::set_tank(int i)
     display->update();
 }
 
-static const QString FUNC_LETTERS = "PQWERTYUIOJπSZK*.FθDΦHNMΔLXGABCV";
-
 // determine an order's suffix, depending on the selected initial orders
-inline QChar order_suffix(bool is_short)
+inline char order_suffix(bool is_short)
 {
     if (Settings::initial_orders() == 1) {
         return is_short ? 'S' : 'L';
@@ -52,39 +51,8 @@ inline QChar order_suffix(bool is_short)
     }
 }
 
-// translate the order in the specified word into an EDSAC order
-inline QString order_to_str(WORD w)
-{
-    QString func = FUNC_LETTERS.at((w & MAX_HIWORD) >> (ADDR_BITS+FLAG_BITS)),
-            suffix = order_suffix((w & MAX_FLAG) == 0);
-    unsigned addr = (w >> FLAG_BITS) & MAX_ADDR;
-    return func + " " + QString::number(addr) + " " + suffix;
-}
-
-// translate the fraction in the specified EDSAC long word into its
-// string representation, with the specified precision
-QString frac_to_str(WORD low, WORD high, unsigned precision)
-{
-    LONGWORD x = long_word(low, high);
-    LONGWORD mask = LONG_SIGN_BIT >> 1;
-    double result = 0.0;
-    if ((x & LONG_SIGN_BIT) != 0) { result = -1.0; }
-    double addend = 0.5;
-    while (mask != 0) {
-        if ((x & mask) != 0) { result += addend; }
-        addend /= 2;
-        mask >>= 1;
-    }
-
-    return QString::number(result, 'f', precision);
-}
-
-// translate the fraction in the specified EDSAC short word into its
-// string representation, with the specified precision
-inline QString frac_to_str(WORD w, unsigned precision)
-{
-    return frac_to_str(0, w, precision);
-}
+// room for the longest hint after the label
+static const size_t HINT_SIZE = 128;
 
 // for short tanks, display the appropriate hints, if required
 // for long tanks, prepare to do so when the cursor is in position
@@ -95,30 +63,42 @@ void Display_Tube::enterEvent(QEvent *e)
         if (is_short) {
             if (Settings::short_tanks()) {
                 WORD *p = data->end() - 1;
-                QString hint = label;
+                char text[HINT_SIZE], *q = text;
 
                 if ((hint_flags & AS_ORDER) != 0) {
-                    if ((hint_flags & LABEL) != 0) { hint += "   Order = "; }
-                    hint += " = " + order_to_str(*p);
+                    if ((hint_flags & LABEL) != 0) {
+                        q = Decimal::text(q, "   Order = ");
+                    }
+                    q = Decimal::text(q, " = ");
+                    q = Decimal::order(q, *p, Settings::initial_orders());
                 }
 
                 if ((hint_flags & AS_INTEGER) != 0) {
-                    if ((hint_flags & LABEL) != 0) { hint += "   Integer"; }
-                    hint += " = " + QString::number(sign_extend(*p));
+                    if ((hint_flags & LABEL) != 0) {
+                        q = Decimal::text(q, "   Integer");
+                    }
+                    q = Decimal::text(q, " = ");
+                    q = Decimal::integer(q, sign_extend(*p));
                     if (num_bits > LOWORD_BITS) {
-                        hint += QString("[") + order_suffix(true) + "]   ";
-                        hint += QString::number(sign_extend(*(p-1), *p))
-                                    + "[" + order_suffix(false) + "]";
+                        *q++ = '[';
+                        *q++ = order_suffix(true);
+                        q = Decimal::text(q, "]   ");
+                        q = Decimal::integer(q, sign_extend(*(p-1), *p));
+                        *q++ = '[';
+                        *q++ = order_suffix(false);
+                        q = Decimal::text(q, "]");
                     }
                 }
 
                 if ((hint_flags & AS_FRAC) != 0) {
                     // LABEL assumed with short tank fractions
                     // 35-bit fractions assumed
-                    hint += "   Fraction = ";
-                    hint += frac_to_str(*(p-1), *p, 15);
+                    q = Decimal::text(q, "   Fraction = ");
+                    q = Decimal::fraction(q, long_word(*(p-1), *p),
+                                          LONGWORD_BITS, 15);
                 }
 
+                QString hint = label + QString::fromUtf8(text, q - text);
                 menu->show_hint(hint);
             }
         } else { setMouseTracking(true); }
@@ -139,34 +119,39 @@ void Display_Tube::leaveEvent(QEvent *e)
 // hints for the EDSAC word under the mouse cursor, if required 
 void Display_Tube::mouseMoveEvent(QMouseEvent *e)
 {   // must be long tank!
-    QString hint = label + " ";
     unsigned line = num_lines - (e->y() / (height() / num_lines) + 1);
     unsigned base = Settings::long_tank() * LONG_TANK_WORDS;
     bool odd = e->x() < width()/2;
     unsigned offset = line*2 + int(odd);
     unsigned addr = base + offset;
     WORD *p = data->begin(offset);
+    char text[HINT_SIZE], *q = text;
 
-    hint += QString::number(addr);
-    hint += "   Order = ";
-    hint += order_to_str(*p);
+    q = Decimal::integer(q, addr);
+    q = Decimal::text(q, "   Order = ");
+    q = Decimal::order(q, *p, Settings::initial_orders());
 
-    hint += "   Integer ";
-    hint += QString::number(addr) + order_suffix(true) + " = ";
-    hint += QString::number(sign_extend(*p));
+    q = Decimal::text(q, "   Integer ");
+    q = Decimal::integer(q, addr);
+    *q++ = order_suffix(true);
+    q = Decimal::text(q, " = ");
+    q = Decimal::integer(q, sign_extend(*p));
 
-    hint += "   Fraction ";
+    q = Decimal::text(q, "   Fraction ");
 
     if (odd) {
-        hint += QString::number(addr & ~0x1) + order_suffix(false) + " = ";
-        hint += frac_to_str(*(p-1), *p, 15);
+        q = Decimal::integer(q, addr & ~0x1);
+        *q++ = order_suffix(false);
+        q = Decimal::text(q, " = ");
+        q = Decimal::fraction(q, long_word(*(p-1), *p), LONGWORD_BITS, 15);
     } else {
-        hint += QString::number(addr) + order_suffix(true) + " = ";
-        // & MAX_HIWORD ???
-        hint += frac_to_str(*p, 6);
+        q = Decimal::integer(q, addr);
+        *q++ = order_suffix(true);
+        q = Decimal::text(q, " = ");
+        q = Decimal::fraction(q, *p, HIWORD_BITS, 6);
     }
 
-    menu->show_hint(hint);
+    menu->show_hint(label + " " + QString::fromUtf8(text, q - text));
 }
 
 void Display_Tube::paintEvent(QPaintEvent *e)
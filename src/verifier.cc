@@ -0,0 +1,332 @@
+/*
+ * verifier.cc -- definitions for Verifier class
+ *                (checking the fast paths against plain interpretation)
+ */
+#include <QString>
+#include <QStringList>
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+#include "verifier.h"
+
+#include "attributes.h"
+#include "cache.h"
+#include "codes.h"
+#include "edsac.h"
+#include "fusion.h"
+#include "intrinsics.h"
+#include "input.h"
+#include "jit.h"
+#include "journal.h"
+#include "output.h"
+#include "postmortem.h"
+#include "settings.h"
+#include "tank.h"
+
+using Codes::code_of;       // punch code for given letter
+
+// most orders plain interpretation may take to catch up with a single
+// fast step (an idle loop fast-forwarded over billions of trips is
+// taken on trust, and counted as unchecked)
+static const uint64_t MAX_CATCH_UP = 10000000;
+
+// names of the short tank words, in the order capture() saves them
+static const char *const REG_NAMES[] = {
+    "acc[0]", "acc[1]", "acc[2]", "acc[3]", "mcand[0]", "mcand[1]",
+    "mplier[0]", "mplier[1]", "sct", "order"
+};
+
+Verifier::Verifier(Edsac *e)
+    : edsac(e)
+{}
+
+// run the mounted tape with each step done both ways until the machine
+// stops (or n orders have been run); returns # differences (0 or 1)
+unsigned long Verifier::run(uint64_t n)
+{
+    forward = edsac->print_hook;
+    uint64_t count = verify(n);
+    fprintf(stderr, "%llu orders verified in %llu steps (%llu too long"
+            " to compare)%s\n", (unsigned long long)count,
+            (unsigned long long)steps, (unsigned long long)unchecked,
+            diverged ? "; the fast paths differ" : "");
+    return diverged;
+}
+
+// run n random programs with each step done both ways (orders chosen to
+// reach every order function, with data and registers at random)
+// returns # differences (0 or 1)
+unsigned long Verifier::check_random(unsigned n)
+{
+    static const unsigned MAX_RUN = 1000;   // orders per program
+    static const char FUNCS[] = "AASSHHVVNNTTUUCCRRLLEEGGYXOF";
+
+    std::mt19937 rng(1949);
+    forward = nullptr;      // (the programs' output is only compared)
+    uint64_t count = 0;
+    unsigned trial;
+    for (trial = 0; trial < n and not diverged; trial++) {
+        // nearly every word an order (the rest anything at all, so now
+        // and then an invalid order stops the program)
+        for (ADDR a = 0; a < STORE_WORDS; a++) {
+            WORD w = rng() & MAX_HIWORD;
+            if (rng() % 64 != 0) {
+                char f = code_of(FUNCS[rng() % (sizeof FUNCS - 1)]);
+                w = WORD(f) << (ADDR_BITS + FLAG_BITS)
+                    | (w & ((MAX_ADDR << FLAG_BITS) | MAX_FLAG));
+            }
+            store_word_at(&edsac->store[tank_num(a)], a & OFFSET_MASK, w);
+        }
+        for (Tank *t : { &edsac->acc, &edsac->mcand, &edsac->mplier }) {
+            for (WORD *q = t->begin(); q != t->end(); q++) {
+                *q = rng() & (q + 1 == t->end() ? MAX_HIWORD : MAX_LOWORD);
+            }
+        }
+        edsac->sct[0] = rng() & MAX_ADDR;
+        edsac->order[0] = 0;
+        edsac->input->set_up_tape(QString());
+        edsac->last_loop = ~0;
+        edsac->jit->flush();
+        edsac->fusion->flush();
+        edsac->intrinsics->flush();
+        count += verify(MAX_RUN);
+    }
+    printf("%u random programs, %llu orders in %llu steps: %s\n", trial,
+           (unsigned long long)count, (unsigned long long)steps,
+           diverged ? "the fast paths differ" : "no differences");
+    return diverged;
+}
+
+// run with each step done both ways until the machine stops, n orders
+// have been run, or the two differ (returns # orders run)
+uint64_t Verifier::verify(uint64_t n)
+{
+    // the fast paths chosen (all of them if none is: each alone is
+    // checked apart, as the JIT leaves fusion little to do), and nothing
+    // kept that a step run twice would spoil (the journal, or the image
+    // of the loading)
+    bool had_intrinsics = Settings::intrinsics();
+    bool had_jit = Settings::jit();
+    bool had_fusion = Settings::fusion();
+    bool had_skip = edsac->skip_loops;
+    int depth = Settings::journal_depth();
+    if (not (had_intrinsics or had_jit or had_fusion)) {
+        Settings::set_intrinsics(true);
+        Settings::set_jit(true);
+        Settings::set_fusion(true);
+    }
+    Settings::set_journal_depth(0);
+    edsac->skip_loops = true;
+    edsac->cache->cancel();
+    auto hook = edsac->print_hook;
+    edsac->print_hook = [this](char c) { printed += c; };
+
+    uint64_t start = edsac->order_count;
+    edsac->quiet = true;
+    edsac->set_stop_light(false);
+    edsac->stopped_by = Edsac::NOT_STOPPED;
+    edsac->running = true;
+    edsac->halted = false;
+    edsac->order_limit = start + n;     // (no fast path goes past n)
+    while (edsac->running and edsac->order_count - start < n) {
+        if (not step()) { break; }
+        if (not edsac->running and edsac->dial_queued()) { continue; }
+    }
+    if (edsac->running) {
+        edsac->running = false;
+        edsac->reset_enabled = true;
+        edsac->stopped_by = Edsac::CONDITION;
+    }
+    edsac->order_limit = Edsac::NO_END;
+    edsac->quiet = Settings::headless();
+
+    edsac->print_hook = hook;
+    edsac->interpret_only = false;
+    edsac->skip_loops = had_skip;
+    Settings::set_journal_depth(depth);
+    Settings::set_intrinsics(had_intrinsics);
+    Settings::set_jit(had_jit);
+    Settings::set_fusion(had_fusion);
+    edsac->journal->clear();
+    edsac->refresh();
+    return edsac->order_count - start;
+}
+
+// do the next step with the fast paths, then by plain interpretation
+// from the same state to the same point; false (after reporting it) if
+// the two differ
+bool Verifier::step()
+{
+    State before = capture();
+
+    edsac->interpret_only = false;
+    printed.clear();
+    edsac->exec_order();
+    State fast = capture();
+
+    restore(before);
+    edsac->interpret_only = true;
+    printed.clear();
+    uint64_t n = 0;
+    do {
+        edsac->exec_order();
+    } while (edsac->running and edsac->order_count < fast.orders
+             and ++n < MAX_CATCH_UP);
+    State ref = capture();
+    ++steps;
+
+    if (n == MAX_CATCH_UP) {            // (taken on trust)
+        ++unchecked;
+        restore(fast);
+        ref = fast;
+    } else if (fast.stopped_by == Edsac::HUNG and ref.running) {
+        restore(fast);      // (a loop that only the fast path can prove
+        ref = fast;         // will never end)
+    }
+    QStringList diffs = differences(ref, fast);
+    if (not diffs.isEmpty()) {
+        report(before, ref, fast, diffs);
+        diverged = true;
+        edsac->running = false;
+        edsac->halted = edsac->reset_enabled = true;
+        edsac->stopped_by = Edsac::STOPPED;
+        return false;
+    }
+    if (forward) {
+        for (QChar c : ref.printed) { forward(c.toLatin1()); }
+    }
+    return true;
+}
+
+// the whole state of the machine (with the output of the last step)
+Verifier::State Verifier::capture() const
+{
+    State s;
+    for (const Tank *t : { &edsac->acc, &edsac->mcand, &edsac->mplier,
+                           &edsac->sct, &edsac->order })
+    {
+        s.regs.insert(s.regs.end(), t->begin(), t->end());
+    }
+    s.store = edsac->store_image();
+    s.time = edsac->sim_time;
+    s.orders = edsac->order_count;
+    s.stopped_by = edsac->stopped_by;
+    s.running = edsac->running;
+    s.halted = edsac->halted;
+    s.reset_enabled = edsac->reset_enabled;
+    s.tape_pos = edsac->input->position();
+    s.tape_line = edsac->input->line();
+    s.last_printed = edsac->last_printed;
+    s.printed = printed;
+    s.last_loop = edsac->last_loop;
+    s.transcript = edsac->transcript;
+    s.chars_printed = edsac->chars_printed;
+    s.transcript_shift = edsac->transcript_shift;
+    return s;
+}
+
+// put the machine back as it was
+void Verifier::restore(const State& s)
+{
+    auto p = s.regs.begin();
+    for (Tank *t : { &edsac->acc, &edsac->mcand, &edsac->mplier,
+                     &edsac->sct, &edsac->order })
+    {
+        for (WORD *q = t->begin(); q != t->end(); q++) { *q = *p++; }
+    }
+    for (ADDR a = 0; a < s.store.size(); a++) {
+        WORD *q = edsac->store[tank_num(a)].begin(a & OFFSET_MASK);
+        if (*q != s.store[a]) {
+            *q = s.store[a];
+            edsac->jit->note_write(a);
+            edsac->fusion->note_write(a);
+            edsac->intrinsics->note_write(a);
+        }
+    }
+    edsac->sim_time = s.time;
+    edsac->order_count = s.orders;
+    edsac->stopped_by = Edsac::Stop_Reason(s.stopped_by);
+    edsac->running = s.running;
+    edsac->halted = s.halted;
+    edsac->reset_enabled = s.reset_enabled;
+    edsac->input->set_position(s.tape_pos, s.tape_line);
+    edsac->last_printed = s.last_printed;
+    printed = s.printed;
+    edsac->last_loop = s.last_loop;
+    edsac->transcript = s.transcript;
+    edsac->chars_printed = s.chars_printed;
+    edsac->transcript_shift = Teleprinter::Shift_Mode(s.transcript_shift);
+}
+
+// what differs between the two states, one line each
+QStringList Verifier::differences(const State& ref, const State& fast) const
+{
+    QStringList result;
+    auto differ = [&result](const QString& what, uint64_t r, uint64_t f) {
+        result << QString("  %1 %2 %3").arg(what, -12)
+                  .arg(r, 14).arg(f, 14);
+    };
+    for (unsigned i = 0; i < ref.regs.size(); i++) {
+        if (ref.regs[i] != fast.regs[i]) {
+            differ(REG_NAMES[i], ref.regs[i], fast.regs[i]);
+        }
+    }
+    for (unsigned a = 0; a < ref.store.size(); a++) {
+        if (ref.store[a] != fast.store[a]) {
+            differ(QString("store %1").arg(a), ref.store[a], fast.store[a]);
+        }
+    }
+    if (ref.time != fast.time) { differ("time", ref.time, fast.time); }
+    if (ref.orders != fast.orders) {
+        differ("orders", ref.orders, fast.orders);
+    }
+    if (ref.stopped_by != fast.stopped_by) {
+        differ("stopped by", ref.stopped_by, fast.stopped_by);
+    }
+    if (ref.running != fast.running) {
+        differ("running", ref.running, fast.running);
+    }
+    if (ref.tape_pos != fast.tape_pos) {
+        differ("tape", ref.tape_pos, fast.tape_pos);
+    }
+    if (ref.last_printed != fast.last_printed) {
+        differ("last printed", ref.last_printed, fast.last_printed);
+    }
+    for (int i = 0; i < std::max(ref.printed.size(), fast.printed.size());
+         i++)
+    {
+        uint64_t r = i < ref.printed.size() ? ref.printed[i].unicode() : ~0;
+        uint64_t f = i < fast.printed.size() ? fast.printed[i].unicode() : ~0;
+        if (r != f) { differ(QString("printed %1").arg(i), r, f); }
+    }
+    return result;
+}
+
+// print the step that went wrong, the orders around it, and how the
+// two states differ
+void Verifier::report(const State& before, const State& ref,
+                      const State& fast, const QStringList& diffs) const
+{
+    static const int CONTEXT = 4;       // orders shown either side
+
+    ADDR at = before.regs[8];           // (sequence control)
+    fprintf(stderr, "first difference in the step starting at %u, after"
+            " %llu orders in all", at, (unsigned long long)before.orders);
+    if (fast.orders - before.orders > 1) {
+        fprintf(stderr, " (%llu orders in one fast step)",
+                (unsigned long long)(fast.orders - before.orders));
+    }
+    fputs(":\n", stderr);
+    for (int d = -CONTEXT; d <= CONTEXT; d++) {
+        ADDR a = (at + d) & MAX_ADDR;
+        WORD w = before.store[a % before.store.size()];
+        fprintf(stderr, "%s%5u  %s   (%06o)\n", d == 0 ? "->" : "  ", a,
+                qPrintable(Post_Mortem::order(w)), unsigned(w));
+    }
+    fprintf(stderr, "  %-12s %14s %14s\n", "", "interpreted", "fast paths");
+    for (const QString& line : diffs) {
+        fprintf(stderr, "%s\n", qPrintable(line));
+    }
+}
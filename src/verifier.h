@@ -0,0 +1,74 @@
+/*
+ * verifier.h -- declarations for Verifier class
+ *               (checking the fast paths against plain interpretation)
+ */
+#ifndef VERIFIER_H
+#define VERIFIER_H
+
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+#include <vector>
+
+#include "attributes.h"
+
+class Edsac;
+
+// Runs the machine a step at a time, doing each step twice from the same
+// state: once with the fast paths (those of library routines run as host
+// code, runs of orders as native code, and fused pairs of orders that
+// are turned on, or all three if none is; and idle loops fast-forwarded),
+// and once by interpreting every order with the order functions alone.
+// The whole machine state -- registers, store, time, order count, run
+// state, tape position, and anything printed -- is compared after each
+// step, and the first difference is reported with a disassembly of the
+// orders around it.
+class Verifier
+{
+public:
+    Verifier(Edsac *e);
+
+    // run the mounted tape this way until the machine stops (or n orders
+    // have been run); returns the number of differences (0 or 1)
+    unsigned long run(uint64_t n);
+
+    // run n random programs (random orders, data, and registers) this
+    // way; returns the number of differences (0 or 1)
+    unsigned long check_random(unsigned n);
+private:
+    struct State {
+        std::vector<WORD> regs;     // every short tank word
+        std::vector<WORD> store;
+        TICKS time;
+        uint64_t orders;
+        int stopped_by;
+        bool running, halted, reset_enabled;
+        int tape_pos, tape_line;
+        char last_printed;
+        QString printed;            // by the last step
+
+        // engine bookkeeping (restored, but not compared)
+        ADDR last_loop;
+        QString transcript;
+        unsigned long chars_printed;
+        int transcript_shift;
+    };
+
+    State capture() const;
+    void restore(const State& s);
+    bool step();
+    QStringList differences(const State& ref, const State& fast) const;
+    void report(const State& before, const State& ref, const State& fast,
+                const QStringList& diffs) const;
+    uint64_t verify(uint64_t n);
+
+    Edsac *edsac;
+    std::function<void(char)> forward;  // where output really goes
+    QString printed;                    // output of the step being run
+    uint64_t steps = 0;                 // # steps compared
+    uint64_t unchecked = 0;             // ... and too long to compare
+    bool diverged = false;
+};
+
+#endif